@@ -0,0 +1,95 @@
+// Minimal micro-benchmark harness used by umlaut_bench.
+//
+// Copyright Marcus Larsson 2018
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench {
+
+/// Prevents the compiler from optimizing away the computation of `value`.
+template <typename T>
+inline void do_not_optimize(T& value) {
+#if defined(__GNUC__)
+    asm volatile("" : "+m"(value) : : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+/// A benchmark runs its operation `iterations` times.
+using function = std::function<void(std::size_t iterations)>;
+
+struct result {
+    std::string name;
+    std::size_t iterations;
+    double median_ns;
+    double min_ns;
+};
+
+class suite {
+ public:
+    void add(std::string name, function f) {
+	m_benchmarks.emplace_back(std::move(name), std::move(f));
+    }
+
+    /// Runs all benchmarks whose name contains `filter`.
+    ///
+    /// The number of iterations is doubled until a run takes at least `min_time`
+    /// seconds, the run is then repeated `samples` times and the median and minimum
+    /// time per iteration are reported.
+    std::vector<result> run(const std::string& filter, double min_time, std::size_t samples) const {
+	std::vector<result> results;
+
+	for (const auto& [name, f] : m_benchmarks) {
+	    if (name.find(filter) == std::string::npos) {
+		continue;
+	    }
+
+	    std::size_t iterations = 1;
+
+	    while (time(f, iterations) < min_time && iterations < (std::size_t(1) << 40)) {
+		iterations *= 2;
+	    }
+
+	    std::vector<double> times;
+
+	    for (std::size_t i = 0; i < samples; ++i) {
+		times.push_back(time(f, iterations) * 1e9 / static_cast<double>(iterations));
+	    }
+
+	    std::sort(times.begin(), times.end());
+	    results.push_back({name, iterations, times[times.size() / 2], times.front()});
+	}
+
+	return results;
+    }
+
+ private:
+    static double time(const function& f, std::size_t iterations) {
+	const auto start = std::chrono::steady_clock::now();
+	f(iterations);
+	const auto stop = std::chrono::steady_clock::now();
+
+	return std::chrono::duration<double>(stop - start).count();
+    }
+
+    std::vector<std::pair<std::string, function>> m_benchmarks;
+};
+
+void register_compressed_pair(suite& s);
+void register_optional(suite& s);
+void register_small_vector(suite& s);
+
+} // namespace bench
@@ -0,0 +1,49 @@
+// Benchmarks of ul::compressed_pair against std::pair.
+//
+// Copyright Marcus Larsson 2018
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "benchmark.hpp"
+
+#include <umlaut/compressed_pair.hpp>
+#include <utility>
+#include <vector>
+
+namespace {
+
+struct empty {
+    int scale(int i) const { return i * 2; }
+};
+
+// Sums `first` scaled by the empty `second`, the compressed pairs are half the size.
+template <typename Pair, typename First, typename Second>
+void access(std::size_t iterations, First first, Second second) {
+    std::vector<Pair> pairs(4096);
+
+    for (std::size_t i = 0; i < iterations; ++i) {
+	long long sum = 0;
+
+	for (auto& p : pairs) {
+	    sum += second(p).scale(first(p));
+	}
+
+	bench::do_not_optimize(sum);
+    }
+}
+
+} // namespace
+
+void bench::register_compressed_pair(suite& s) {
+    using compressed = ul::compressed_pair<int, empty>;
+    using pair = std::pair<int, empty>;
+
+    s.add("compressed_pair/access_4096/ul", [](std::size_t iterations) {
+	access<compressed>(iterations, [](compressed& p) { return p.first(); },
+			   [](compressed& p) -> empty& { return p.second(); });
+    });
+    s.add("compressed_pair/access_4096/std", [](std::size_t iterations) {
+	access<pair>(iterations, [](pair& p) { return p.first; },
+		     [](pair& p) -> empty& { return p.second; });
+    });
+}
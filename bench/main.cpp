@@ -0,0 +1,71 @@
+// Runs the umlaut micro-benchmarks.
+//
+// Usage: umlaut_bench [--filter=<substring>] [--min-time=<seconds>] [--samples=<n>]
+//                     [--format=json|csv]
+//
+// Every benchmark is printed on its own line, either as a JSON object or as CSV, with
+// the median and minimum time per iteration in nanoseconds.
+//
+// Copyright Marcus Larsson 2018
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "benchmark.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+int main(int argc, char** argv) {
+    std::string filter;
+    std::string format = "json";
+    double min_time = 0.1;
+    std::size_t samples = 5;
+
+    for (int i = 1; i < argc; ++i) {
+	const std::string arg = argv[i];
+	const auto value = arg.substr(arg.find('=') + 1);
+
+	if (arg.rfind("--filter=", 0) == 0) {
+	    filter = value;
+	}
+	else if (arg.rfind("--min-time=", 0) == 0) {
+	    min_time = std::atof(value.c_str());
+	}
+	else if (arg.rfind("--samples=", 0) == 0) {
+	    samples = static_cast<std::size_t>(std::atoi(value.c_str()));
+	}
+	else if (arg.rfind("--format=", 0) == 0 && (value == "json" || value == "csv")) {
+	    format = value;
+	}
+	else {
+	    std::fprintf(stderr, "usage: %s [--filter=<substring>] [--min-time=<seconds>] "
+			 "[--samples=<n>] [--format=json|csv]\n", argv[0]);
+	    return EXIT_FAILURE;
+	}
+    }
+
+    bench::suite suite;
+    bench::register_compressed_pair(suite);
+    bench::register_optional(suite);
+    bench::register_small_vector(suite);
+
+    const auto results = suite.run(filter, min_time, samples > 0 ? samples : 1);
+
+    if (format == "csv") {
+	std::printf("name,iterations,median_ns,min_ns\n");
+    }
+
+    for (const auto& r : results) {
+	if (format == "csv") {
+	    std::printf("%s,%zu,%.3f,%.3f\n", r.name.c_str(), r.iterations, r.median_ns, r.min_ns);
+	}
+	else {
+	    std::printf("{\"name\": \"%s\", \"iterations\": %zu, \"median_ns\": %.3f, \"min_ns\": %.3f}\n",
+			r.name.c_str(), r.iterations, r.median_ns, r.min_ns);
+	}
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,83 @@
+// Benchmarks of ul::optional against std::optional.
+//
+// Copyright Marcus Larsson 2018
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "benchmark.hpp"
+
+#include <umlaut/optional.hpp>
+#include <optional>
+#include <string>
+
+namespace {
+
+template <typename Optional>
+void construct(std::size_t iterations) {
+    for (std::size_t i = 0; i < iterations; ++i) {
+	int value = static_cast<int>(i);
+	bench::do_not_optimize(value);
+
+	Optional opt(value);
+	bench::do_not_optimize(opt);
+    }
+}
+
+template <typename Optional>
+void assign(std::size_t iterations) {
+    Optional opt;
+    typename Optional::value_type value{};
+
+    for (std::size_t i = 0; i < iterations; ++i) {
+	bench::do_not_optimize(value);
+
+	if (i % 2 == 0) {
+	    opt = value;
+	}
+	else {
+	    opt.reset();
+	}
+
+	bench::do_not_optimize(opt);
+    }
+}
+
+constexpr auto half = [](int i) { return i / 2; };
+constexpr auto positive = [](int i) { return i > 0 ? ul::optional<int>(i) : ul::optional<int>(ul::nullopt); };
+constexpr auto positive_std = [](int i) { return i > 0 ? std::optional<int>(i) : std::nullopt; };
+
+void then_chain(std::size_t iterations) {
+    for (std::size_t i = 0; i < iterations; ++i) {
+	ul::optional<int> opt = i % 4 == 0 ? ul::optional<int>(ul::nullopt) : ul::optional<int>(static_cast<int>(i));
+	bench::do_not_optimize(opt);
+
+	int result = opt.then(half).then(positive).then(half).value_or(-1);
+	bench::do_not_optimize(result);
+    }
+}
+
+// std::optional has no monadic operations in C++17, this is the equivalent hand
+// written chain.
+void then_chain_std(std::size_t iterations) {
+    for (std::size_t i = 0; i < iterations; ++i) {
+	std::optional<int> opt = i % 4 == 0 ? std::nullopt : std::optional<int>(static_cast<int>(i));
+	bench::do_not_optimize(opt);
+
+	std::optional<int> a = opt ? std::optional<int>(half(*opt)) : std::nullopt;
+	std::optional<int> b = a ? positive_std(*a) : std::nullopt;
+	std::optional<int> c = b ? std::optional<int>(half(*b)) : std::nullopt;
+	int result = c.value_or(-1);
+	bench::do_not_optimize(result);
+    }
+}
+
+} // namespace
+
+void bench::register_optional(suite& s) {
+    s.add("optional/construct/ul", construct<ul::optional<int>>);
+    s.add("optional/construct/std", construct<std::optional<int>>);
+    s.add("optional/assign_string/ul", assign<ul::optional<std::string>>);
+    s.add("optional/assign_string/std", assign<std::optional<std::string>>);
+    s.add("optional/then_chain/ul", then_chain);
+    s.add("optional/then_chain/std", then_chain_std);
+}
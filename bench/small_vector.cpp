@@ -0,0 +1,76 @@
+// Benchmarks of ul::small_vector against std::vector.
+//
+// Copyright Marcus Larsson 2018
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "benchmark.hpp"
+
+#include <umlaut/small_vector.hpp>
+#include <string>
+#include <vector>
+
+namespace {
+
+template <typename Vector>
+void push_back_small(std::size_t iterations) {
+    for (std::size_t i = 0; i < iterations; ++i) {
+	Vector v;
+
+	for (int j = 0; j < 16; ++j) {
+	    v.push_back(j);
+	}
+
+	bench::do_not_optimize(v);
+    }
+}
+
+template <typename Vector>
+void growth(std::size_t iterations) {
+    for (std::size_t i = 0; i < iterations; ++i) {
+	Vector v;
+
+	for (int j = 0; j < 1000; ++j) {
+	    v.push_back(typename Vector::value_type(j));
+	}
+
+	bench::do_not_optimize(v);
+    }
+}
+
+template <typename Vector>
+void insert_erase(std::size_t iterations) {
+    Vector v;
+
+    for (int j = 0; j < 256; ++j) {
+	v.push_back(typename Vector::value_type(j));
+    }
+
+    for (std::size_t i = 0; i < iterations; ++i) {
+	const auto index = static_cast<std::ptrdiff_t>(i % 256);
+
+	v.insert(v.begin() + index, typename Vector::value_type(1));
+	bench::do_not_optimize(v);
+	v.erase(v.begin() + index);
+    }
+}
+
+struct string {
+    string(int i) : value(std::to_string(i)) {}
+    std::string value;
+};
+
+} // namespace
+
+void bench::register_small_vector(suite& s) {
+    s.add("small_vector/push_back_16/ul", push_back_small<ul::small_vector<int, 16>>);
+    s.add("small_vector/push_back_16/std", push_back_small<std::vector<int>>);
+    s.add("small_vector/growth_1000/ul", growth<ul::small_vector<int, 8>>);
+    s.add("small_vector/growth_1000/std", growth<std::vector<int>>);
+    s.add("small_vector/growth_1000_string/ul", growth<ul::small_vector<string, 8>>);
+    s.add("small_vector/growth_1000_string/std", growth<std::vector<string>>);
+    s.add("small_vector/insert_erase_256/ul", insert_erase<ul::small_vector<int, 8>>);
+    s.add("small_vector/insert_erase_256/std", insert_erase<std::vector<int>>);
+    s.add("small_vector/insert_erase_256_string/ul", insert_erase<ul::small_vector<string, 8>>);
+    s.add("small_vector/insert_erase_256_string/std", insert_erase<std::vector<string>>);
+}
@@ -8,8 +8,17 @@
 #pragma once
 
 #include "umlaut/config.hpp"
+#include "umlaut/algorithm.hpp"
+#include "umlaut/allocator.hpp"
+#include "umlaut/arena.hpp"
 #include "umlaut/compressed_pair.hpp"
+#include "umlaut/flat_map.hpp"
 #include "umlaut/optional.hpp"
+#include "umlaut/optional_array.hpp"
+#include "umlaut/small_ring_buffer.hpp"
+#include "umlaut/small_string.hpp"
 #include "umlaut/small_vector.hpp"
 #include "umlaut/special_members.hpp"
+#include "umlaut/static_vector.hpp"
+#include "umlaut/stats.hpp"
 #include "umlaut/traits.hpp"
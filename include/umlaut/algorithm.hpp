@@ -0,0 +1,329 @@
+/// @file
+/// Defines ul::find, ul::count and ul::contains.
+///
+/// @copyright Marcus Larsson 2018
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "config.hpp"
+#include "traits.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+
+#if UMLAUT_ENABLE_SIMD
+#include <immintrin.h>
+#define UMLAUT_TARGET_AVX2 __attribute__((target("avx2,popcnt")))
+#endif
+
+namespace ul {
+namespace detail {
+
+/// Whether a `T` can be compared with a `U` using the SIMD kernels, i.e. `T` is an
+/// arithmetic or enumeration type of 1, 2, 4 or 8 bytes and comparing against the
+/// `value` converted to `T` gives the same result as comparing against `value`.
+template <typename T, typename U>
+inline constexpr bool is_simd_comparable_v =
+    (std::is_arithmetic_v<T> || std::is_enum_v<T>) &&
+    (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8) &&
+    (std::is_same_v<T, U> ||
+     (std::is_arithmetic_v<T> && std::is_arithmetic_v<U> &&
+      !(std::is_integral_v<T> && std::is_floating_point_v<U>)));
+
+/// Converts `value` to `T`, returns false if no `T` can compare equal to `value`.
+template <typename T, typename U>
+bool convert_needle(const U& value, T& needle) noexcept {
+    needle = static_cast<T>(value);
+
+    if constexpr (std::is_same_v<T, U>) {
+	return true;
+    } else {
+	using common = std::common_type_t<T, U>;
+	return static_cast<common>(needle) == static_cast<common>(value);
+    }
+}
+
+template <typename T>
+const T* find_scalar(const T* first, const T* last, T needle) noexcept {
+    for (; first != last; ++first) {
+	if (*first == needle) {
+	    return first;
+	}
+    }
+
+    return last;
+}
+
+template <typename T>
+std::ptrdiff_t count_scalar(const T* first, const T* last, T needle) noexcept {
+    std::ptrdiff_t result = 0;
+
+    for (; first != last; ++first) {
+	result += *first == needle;
+    }
+
+    return result;
+}
+
+#if UMLAUT_ENABLE_SIMD
+
+// All kernels compare whole registers and turn the result into a byte mask where every
+// matching element sets `sizeof(T)` consecutive bits. Floating point elements are
+// compared as such so that `-0.0` equals `0.0` and NaN never matches, like `==`.
+
+template <typename T>
+auto needle_bits(T needle) noexcept {
+    using bits = std::conditional_t<sizeof(T) == 1, std::uint8_t,
+		 std::conditional_t<sizeof(T) == 2, std::uint16_t,
+		 std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>>>;
+
+    bits result;
+    std::memcpy(&result, &needle, sizeof(T));
+    return result;
+}
+
+template <typename T>
+__m128i sse2_broadcast(T needle) noexcept {
+    const auto bits = needle_bits(needle);
+
+    if constexpr (sizeof(T) == 1) {
+	return _mm_set1_epi8(static_cast<char>(bits));
+    } else if constexpr (sizeof(T) == 2) {
+	return _mm_set1_epi16(static_cast<short>(bits));
+    } else if constexpr (sizeof(T) == 4) {
+	return _mm_set1_epi32(static_cast<int>(bits));
+    } else {
+	return _mm_set1_epi64x(static_cast<long long>(bits));
+    }
+}
+
+template <typename T>
+unsigned sse2_match(const T* ptr, __m128i needle) noexcept {
+    const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+    __m128i equal;
+
+    if constexpr (std::is_same_v<T, float>) {
+	equal = _mm_castps_si128(_mm_cmpeq_ps(_mm_castsi128_ps(block), _mm_castsi128_ps(needle)));
+    } else if constexpr (std::is_same_v<T, double>) {
+	equal = _mm_castpd_si128(_mm_cmpeq_pd(_mm_castsi128_pd(block), _mm_castsi128_pd(needle)));
+    } else if constexpr (sizeof(T) == 1) {
+	equal = _mm_cmpeq_epi8(block, needle);
+    } else if constexpr (sizeof(T) == 2) {
+	equal = _mm_cmpeq_epi16(block, needle);
+    } else if constexpr (sizeof(T) == 4) {
+	equal = _mm_cmpeq_epi32(block, needle);
+    } else {
+	// SSE2 has no 64-bit compare, both halves have to be equal.
+	equal = _mm_cmpeq_epi32(block, needle);
+	equal = _mm_and_si128(equal, _mm_shuffle_epi32(equal, _MM_SHUFFLE(2, 3, 0, 1)));
+    }
+
+    return static_cast<unsigned>(_mm_movemask_epi8(equal));
+}
+
+template <typename T>
+const T* find_sse2(const T* first, const T* last, T needle) noexcept {
+    constexpr std::ptrdiff_t lanes = 16 / sizeof(T);
+    const __m128i broadcast = sse2_broadcast(needle);
+
+    for (; last - first >= lanes; first += lanes) {
+	if (const unsigned mask = sse2_match(first, broadcast); mask != 0) {
+	    return first + __builtin_ctz(mask) / sizeof(T);
+	}
+    }
+
+    return find_scalar(first, last, needle);
+}
+
+template <typename T>
+std::ptrdiff_t count_sse2(const T* first, const T* last, T needle) noexcept {
+    constexpr std::ptrdiff_t lanes = 16 / sizeof(T);
+    const __m128i broadcast = sse2_broadcast(needle);
+    std::ptrdiff_t bits = 0;
+
+    for (; last - first >= lanes; first += lanes) {
+	bits += __builtin_popcount(sse2_match(first, broadcast));
+    }
+
+    return bits / static_cast<std::ptrdiff_t>(sizeof(T)) + count_scalar(first, last, needle);
+}
+
+template <typename T>
+UMLAUT_TARGET_AVX2 __m256i avx2_broadcast(T needle) noexcept {
+    const auto bits = needle_bits(needle);
+
+    if constexpr (sizeof(T) == 1) {
+	return _mm256_set1_epi8(static_cast<char>(bits));
+    } else if constexpr (sizeof(T) == 2) {
+	return _mm256_set1_epi16(static_cast<short>(bits));
+    } else if constexpr (sizeof(T) == 4) {
+	return _mm256_set1_epi32(static_cast<int>(bits));
+    } else {
+	return _mm256_set1_epi64x(static_cast<long long>(bits));
+    }
+}
+
+template <typename T>
+UMLAUT_TARGET_AVX2 unsigned avx2_match(const T* ptr, __m256i needle) noexcept {
+    const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+    __m256i equal;
+
+    if constexpr (std::is_same_v<T, float>) {
+	equal = _mm256_castps_si256(
+	    _mm256_cmp_ps(_mm256_castsi256_ps(block), _mm256_castsi256_ps(needle), _CMP_EQ_OQ));
+    } else if constexpr (std::is_same_v<T, double>) {
+	equal = _mm256_castpd_si256(
+	    _mm256_cmp_pd(_mm256_castsi256_pd(block), _mm256_castsi256_pd(needle), _CMP_EQ_OQ));
+    } else if constexpr (sizeof(T) == 1) {
+	equal = _mm256_cmpeq_epi8(block, needle);
+    } else if constexpr (sizeof(T) == 2) {
+	equal = _mm256_cmpeq_epi16(block, needle);
+    } else if constexpr (sizeof(T) == 4) {
+	equal = _mm256_cmpeq_epi32(block, needle);
+    } else {
+	equal = _mm256_cmpeq_epi64(block, needle);
+    }
+
+    return static_cast<unsigned>(_mm256_movemask_epi8(equal));
+}
+
+template <typename T>
+UMLAUT_TARGET_AVX2 const T* find_avx2(const T* first, const T* last, T needle) noexcept {
+    constexpr std::ptrdiff_t lanes = 32 / sizeof(T);
+    const __m256i broadcast = avx2_broadcast(needle);
+
+    for (; last - first >= lanes; first += lanes) {
+	if (const unsigned mask = avx2_match(first, broadcast); mask != 0) {
+	    return first + __builtin_ctz(mask) / sizeof(T);
+	}
+    }
+
+    return find_sse2(first, last, needle);
+}
+
+template <typename T>
+UMLAUT_TARGET_AVX2 std::ptrdiff_t count_avx2(const T* first, const T* last, T needle) noexcept {
+    constexpr std::ptrdiff_t lanes = 32 / sizeof(T);
+    const __m256i broadcast = avx2_broadcast(needle);
+    std::ptrdiff_t bits = 0;
+
+    for (; last - first >= lanes; first += lanes) {
+	bits += __builtin_popcount(avx2_match(first, broadcast));
+    }
+
+    return bits / static_cast<std::ptrdiff_t>(sizeof(T)) + count_sse2(first, last, needle);
+}
+
+/// Whether the running CPU supports AVX2, checked once.
+inline bool cpu_has_avx2() noexcept {
+#if defined(__AVX2__)
+    return true;
+#else
+    static const bool result = [] {
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+    }();
+
+    return result;
+#endif
+}
+
+#endif // UMLAUT_ENABLE_SIMD
+
+template <typename T>
+const T* find_kernel(const T* first, const T* last, T needle) noexcept {
+#if UMLAUT_ENABLE_SIMD
+    return cpu_has_avx2() ? find_avx2(first, last, needle) : find_sse2(first, last, needle);
+#else
+    return find_scalar(first, last, needle);
+#endif
+}
+
+template <typename T>
+std::ptrdiff_t count_kernel(const T* first, const T* last, T needle) noexcept {
+#if UMLAUT_ENABLE_SIMD
+    return cpu_has_avx2() ? count_avx2(first, last, needle) : count_sse2(first, last, needle);
+#else
+    return count_scalar(first, last, needle);
+#endif
+}
+
+template <typename It, typename U>
+inline constexpr bool use_simd_kernel_v =
+    is_contiguous_iterator_v<It> &&
+    is_simd_comparable_v<std::remove_cv_t<typename std::iterator_traits<It>::value_type>, U>;
+
+} // namespace detail
+
+/// @brief Returns an iterator to the first element in `[first, last)` equal to `value`,
+/// or `last` if there is none.
+///
+/// Same as `std::find` but contiguous ranges of arithmetic and enumeration types are
+/// searched using SSE2/AVX2 where available.
+template <typename It, typename U>
+It find(It first, It last, const U& value) {
+    if constexpr (detail::use_simd_kernel_v<It, U>) {
+	using value_type = std::remove_cv_t<typename std::iterator_traits<It>::value_type>;
+	value_type needle;
+
+	if (!detail::convert_needle(value, needle)) {
+	    return last;
+	}
+
+	return first + (detail::find_kernel<value_type>(first, last, needle) - first);
+    } else {
+	return std::find(first, last, value);
+    }
+}
+
+/// @brief Returns the number of elements in `[first, last)` equal to `value`.
+///
+/// Same as `std::count` but vectorized like ul::find().
+template <typename It, typename U>
+typename std::iterator_traits<It>::difference_type count(It first, It last, const U& value) {
+    if constexpr (detail::use_simd_kernel_v<It, U>) {
+	using value_type = std::remove_cv_t<typename std::iterator_traits<It>::value_type>;
+	value_type needle;
+
+	if (!detail::convert_needle(value, needle)) {
+	    return 0;
+	}
+
+	return detail::count_kernel<value_type>(first, last, needle);
+    } else {
+	return std::count(first, last, value);
+    }
+}
+
+/// @brief Returns whether any element in `[first, last)` is equal to `value`.
+template <typename It, typename U>
+bool contains(It first, It last, const U& value) {
+    return ul::find(first, last, value) != last;
+}
+
+/// @brief Range overload of ul::find(), f.e. for ul::small_vector_base.
+template <typename Range, typename U>
+auto find(Range&& range, const U& value) -> decltype(std::begin(range)) {
+    return ul::find(std::begin(range), std::end(range), value);
+}
+
+/// @brief Range overload of ul::count().
+template <typename Range, typename U>
+auto count(Range&& range, const U& value)
+    -> typename std::iterator_traits<decltype(std::begin(range))>::difference_type {
+    return ul::count(std::begin(range), std::end(range), value);
+}
+
+/// @brief Range overload of ul::contains().
+template <typename Range, typename U>
+auto contains(Range&& range, const U& value) -> decltype(std::begin(range), bool()) {
+    return ul::contains(std::begin(range), std::end(range), value);
+}
+
+} // namespace ul
@@ -0,0 +1,301 @@
+/// @file
+/// Defines allocators and allocator adaptors.
+///
+/// @copyright Marcus Larsson 2018
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "config.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if defined(MREMAP_MAYMOVE)
+#define UMLAUT_HAS_MREMAP
+#endif
+#endif
+
+namespace ul {
+
+/// @brief Allocator adaptor which default initializes instead of value initializes.
+///
+/// Containers value initialize their elements through `construct(ptr)`, which for trivial
+/// types such as integers means zero filling the memory. This adaptor turns that into a
+/// default initialization, so f.e. small_vector_base::resize() leaves new integers
+/// uninitialized. Construction with arguments is forwarded to `Alloc`.
+template <typename T, typename Alloc = std::allocator<T>>
+class default_init_allocator : public Alloc {
+    using alloc_traits = std::allocator_traits<Alloc>;
+
+    static_assert(std::is_same_v<typename alloc_traits::value_type, T>,
+		  "Alloc::value_type must be the same as T");
+
+ public:
+    template <typename U>
+    struct rebind {
+	using other = default_init_allocator<U, typename alloc_traits::template rebind_alloc<U>>;
+    };
+
+    using Alloc::Alloc;
+
+    default_init_allocator() = default;
+
+    template <typename U, typename A>
+    default_init_allocator(const default_init_allocator<U, A>& other) noexcept
+	: Alloc(static_cast<const A&>(other)) {}
+
+    template <typename U>
+    void construct(U* ptr) noexcept(std::is_nothrow_default_constructible_v<U>) {
+	::new (static_cast<void*>(ptr)) U;
+    }
+
+    template <typename U, typename ...Args>
+    void construct(U* ptr, Args&&... args) {
+	alloc_traits::construct(static_cast<Alloc&>(*this), ptr, std::forward<Args>(args)...);
+    }
+};
+
+/// @brief Traits class used to determine if an allocator can resize an allocation.
+///
+/// Such allocators have a member `reallocate(ptr, old_n, new_n)` which behaves like
+/// `std::realloc`, the returned allocation holds the bytes of the first `min(old_n, new_n)`
+/// elements of `ptr`, which is deallocated. If it throws `ptr` is left untouched.
+/// ul::small_vector_base grows through it when the elements are trivially relocatable.
+template <typename Alloc, typename = void>
+struct is_reallocating_allocator : std::false_type {};
+
+template <typename Alloc>
+struct is_reallocating_allocator<Alloc, std::void_t<decltype(std::declval<Alloc&>().reallocate(
+    std::declval<typename std::allocator_traits<Alloc>::pointer>(), std::size_t{}, std::size_t{}))>>
+    : std::true_type {};
+
+/// @relates is_reallocating_allocator
+template <typename Alloc>
+inline constexpr bool is_reallocating_allocator_v = is_reallocating_allocator<Alloc>::value;
+
+/// @brief Allocator using `std::malloc` which can grow allocations in place.
+///
+/// Allocations smaller than `UMLAUT_MREMAP_THRESHOLD` bytes are resized with
+/// `std::realloc`. On Linux larger allocations are mapped directly with `mmap` and
+/// resized with `mremap`, which moves the pages instead of copying their contents.
+template <typename T>
+class reallocating_allocator {
+    static_assert(alignof(T) <= alignof(std::max_align_t), "over-aligned types are not supported");
+
+ public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    reallocating_allocator() = default;
+
+    template <typename U>
+    reallocating_allocator(const reallocating_allocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+	const std::size_t bytes = checked_bytes(n);
+	void* ptr;
+
+#if defined(UMLAUT_HAS_MREMAP)
+	if (is_mapped(bytes)) {
+	    ptr = ::mmap(nullptr, page_round(bytes), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	    ptr = ptr == MAP_FAILED ? nullptr : ptr;
+	}
+	else
+#endif
+	{
+	    ptr = std::malloc(bytes > 0 ? bytes : 1);
+	}
+
+	if (UMLAUT_UNLIKELY(ptr == nullptr)) {
+	    throw std::bad_alloc();
+	}
+
+	return static_cast<T*>(ptr);
+    }
+
+    void deallocate(T* ptr, std::size_t n) noexcept {
+#if defined(UMLAUT_HAS_MREMAP)
+	const std::size_t bytes = n * sizeof(T);
+
+	if (is_mapped(bytes)) {
+	    ::munmap(static_cast<void*>(ptr), page_round(bytes));
+	    return;
+	}
+#else
+	static_cast<void>(n);
+#endif
+
+	std::free(static_cast<void*>(ptr));
+    }
+
+    /// @brief Resizes the allocation at `ptr` from `old_n` to `new_n` elements.
+    /// @throws std::bad_alloc if the allocation fails, `ptr` is then left untouched.
+    T* reallocate(T* ptr, std::size_t old_n, std::size_t new_n) {
+	const std::size_t old_bytes = old_n * sizeof(T);
+	const std::size_t new_bytes = checked_bytes(new_n);
+	void* result;
+
+#if defined(UMLAUT_HAS_MREMAP)
+	if (is_mapped(old_bytes) != is_mapped(new_bytes)) {
+	    T* new_ptr = allocate(new_n);
+	    std::memcpy(static_cast<void*>(new_ptr), static_cast<const void*>(ptr),
+			old_bytes < new_bytes ? old_bytes : new_bytes);
+	    deallocate(ptr, old_n);
+	    return new_ptr;
+	}
+
+	if (is_mapped(new_bytes)) {
+	    result = ::mremap(static_cast<void*>(ptr), page_round(old_bytes), page_round(new_bytes), MREMAP_MAYMOVE);
+	    result = result == MAP_FAILED ? nullptr : result;
+	}
+	else
+#else
+	static_cast<void>(old_bytes);
+#endif
+	{
+	    result = std::realloc(static_cast<void*>(ptr), new_bytes > 0 ? new_bytes : 1);
+	}
+
+	if (UMLAUT_UNLIKELY(result == nullptr)) {
+	    throw std::bad_alloc();
+	}
+
+	return static_cast<T*>(result);
+    }
+
+ private:
+    static std::size_t checked_bytes(std::size_t n) {
+	if (UMLAUT_UNLIKELY(n > std::numeric_limits<std::size_t>::max() / sizeof(T))) {
+	    throw std::bad_array_new_length();
+	}
+
+	return n * sizeof(T);
+    }
+
+#if defined(UMLAUT_HAS_MREMAP)
+    static bool is_mapped(std::size_t bytes) noexcept {
+	return bytes >= static_cast<std::size_t>(UMLAUT_MREMAP_THRESHOLD);
+    }
+
+    static std::size_t page_round(std::size_t bytes) noexcept {
+	static const auto page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+	return (bytes + page_size - 1) / page_size * page_size;
+    }
+#endif
+};
+
+template <typename T, typename U>
+constexpr bool operator==(const reallocating_allocator<T>&, const reallocating_allocator<U>&) noexcept {
+    return true;
+}
+
+template <typename T, typename U>
+constexpr bool operator!=(const reallocating_allocator<T>&, const reallocating_allocator<U>&) noexcept {
+    return false;
+}
+
+/// @brief Allocator backing large allocations with transparent huge pages.
+///
+/// Allocations of at least `UMLAUT_HUGE_PAGE_THRESHOLD` bytes are mapped with `mmap`,
+/// aligned to and rounded up to huge_page_allocator::huge_page_size and marked with
+/// `madvise(MADV_HUGEPAGE)`, which reduces TLB misses on random access. Smaller
+/// allocations, and all allocations on platforms other than Linux, use `operator new`.
+template <typename T>
+class huge_page_allocator {
+ public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    /// @brief Size of a huge page on x86-64 and the alignment of mapped allocations.
+    static constexpr std::size_t huge_page_size = std::size_t(1) << 21;
+
+    huge_page_allocator() = default;
+
+    template <typename U>
+    huge_page_allocator(const huge_page_allocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+#if defined(__linux__)
+	if (n <= (std::numeric_limits<std::size_t>::max() - 2 * huge_page_size) / sizeof(T) &&
+	    is_mapped(n * sizeof(T))) {
+	    return static_cast<T*>(map(huge_page_round(n * sizeof(T))));
+	}
+#endif
+
+	return std::allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T* ptr, std::size_t n) noexcept {
+#if defined(__linux__)
+	if (is_mapped(n * sizeof(T))) {
+	    ::munmap(static_cast<void*>(ptr), huge_page_round(n * sizeof(T)));
+	    return;
+	}
+#endif
+
+	std::allocator<T>{}.deallocate(ptr, n);
+    }
+
+ private:
+#if defined(__linux__)
+    static bool is_mapped(std::size_t bytes) noexcept {
+	return bytes >= static_cast<std::size_t>(UMLAUT_HUGE_PAGE_THRESHOLD);
+    }
+
+    static std::size_t huge_page_round(std::size_t bytes) noexcept {
+	return (bytes + huge_page_size - 1) & ~(huge_page_size - 1);
+    }
+
+    /// Maps `bytes` bytes aligned to a huge page by over-allocating and unmapping the
+    /// unaligned head and the remaining tail.
+    static void* map(std::size_t bytes) {
+	void* ptr = ::mmap(nullptr, bytes + huge_page_size, PROT_READ | PROT_WRITE,
+			   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+	if (UMLAUT_UNLIKELY(ptr == MAP_FAILED)) {
+	    throw std::bad_alloc();
+	}
+
+	auto first = static_cast<unsigned char*>(ptr);
+	const auto address = reinterpret_cast<std::uintptr_t>(first);
+	const std::size_t head = huge_page_round(address) - address;
+
+	if (head > 0) {
+	    ::munmap(static_cast<void*>(first), head);
+	}
+
+	::munmap(static_cast<void*>(first + head + bytes), huge_page_size - head);
+
+#if defined(MADV_HUGEPAGE)
+	::madvise(static_cast<void*>(first + head), bytes, MADV_HUGEPAGE);
+#endif
+
+	return first + head;
+    }
+#endif
+};
+
+template <typename T, typename U>
+constexpr bool operator==(const huge_page_allocator<T>&, const huge_page_allocator<U>&) noexcept {
+    return true;
+}
+
+template <typename T, typename U>
+constexpr bool operator!=(const huge_page_allocator<T>&, const huge_page_allocator<U>&) noexcept {
+    return false;
+}
+
+} // namespace ul
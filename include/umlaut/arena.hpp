@@ -0,0 +1,237 @@
+/// @file
+/// Defines ul::monotonic_arena and ul::arena_allocator.
+///
+/// @copyright Marcus Larsson 2018
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "config.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+namespace ul {
+
+/// @brief Bump pointer arena.
+///
+/// Memory is handed out from large blocks by incrementing a pointer and is only given
+/// back all at once, either by rewinding to a marker obtained from
+/// monotonic_arena::mark() or by monotonic_arena::release(). Rewinding within a block is
+/// a single pointer reset. Each new block is twice the size of the previous one.
+class monotonic_arena {
+    struct block {
+	block* prev;
+	std::size_t size;
+    };
+
+    static constexpr std::size_t header_size =
+	(sizeof(block) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+
+ public:
+    /// @brief Position in the arena which can be rewound to.
+    class marker {
+	friend class monotonic_arena;
+
+	marker(block* b, std::byte* current) noexcept : m_block(b), m_current(current) {}
+
+	block* m_block;
+	std::byte* m_current;
+    };
+
+    /// @brief Creates an empty arena, no memory is allocated until it is used.
+    /// @param initial_block_size Size in bytes of the first block.
+    explicit monotonic_arena(std::size_t initial_block_size = 4096) noexcept
+	: m_next_block_size(initial_block_size > 0 ? initial_block_size : 1) {}
+
+    monotonic_arena(const monotonic_arena&) = delete;
+    monotonic_arena& operator=(const monotonic_arena&) = delete;
+
+    ~monotonic_arena() {
+	free_blocks(nullptr);
+    }
+
+    /// @brief Allocates `bytes` bytes aligned to `alignment`.
+    /// @throws std::bad_alloc if the arena has to grow and the allocation fails.
+    void* allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t)) {
+	std::byte* ptr = align(m_current, alignment);
+
+	// the padding is checked on its own since aligning can move `ptr` past `m_end`
+	const auto available = static_cast<std::size_t>(m_end - m_current);
+	const auto padding = static_cast<std::size_t>(ptr - m_current);
+
+	if (UMLAUT_UNLIKELY(ptr == nullptr || padding > available || bytes > available - padding)) {
+	    add_block(bytes, alignment);
+	    ptr = align(m_current, alignment);
+	}
+
+	m_current = ptr + bytes;
+	return ptr;
+    }
+
+    /// @brief Deallocates memory allocated by monotonic_arena::allocate().
+    ///
+    /// Memory is only reclaimed if it is the most recent allocation, everything else is
+    /// reclaimed by monotonic_arena::release().
+    void deallocate(void* ptr, std::size_t bytes) noexcept {
+	if (static_cast<std::byte*>(ptr) + bytes == m_current) {
+	    m_current = static_cast<std::byte*>(ptr);
+	}
+    }
+
+    /// @brief Returns the current position in the arena.
+    marker mark() const noexcept { return marker(m_head, m_current); }
+
+    /// @brief Rewinds the arena to `position`.
+    ///
+    /// All memory allocated since `position` was obtained is reclaimed at once and blocks
+    /// added after it are freed. If the block of `position` has already been freed by
+    /// monotonic_arena::release(), the arena is rewound to its start.
+    void release(marker position) noexcept {
+	if (position.m_block == nullptr || !owns(position.m_block)) {
+	    release();
+	    return;
+	}
+
+	free_blocks(position.m_block);
+	m_current = position.m_current;
+	m_end = block_end(m_head);
+    }
+
+    /// @brief Reclaims all memory of the arena.
+    ///
+    /// The most recently added block, which is also the largest one, is kept so that an
+    /// arena reused for a similar workload does not have to allocate again.
+    void release() noexcept {
+	if (m_head == nullptr) {
+	    return;
+	}
+
+	block* newest = m_head;
+	m_head = newest->prev;
+	free_blocks(nullptr);
+
+	newest->prev = nullptr;
+	m_head = newest;
+	m_current = block_begin(newest);
+	m_end = block_end(newest);
+    }
+
+    /// @brief Returns the number of bytes obtained from the global allocator.
+    std::size_t capacity() const noexcept {
+	std::size_t result = 0;
+
+	for (block* b = m_head; b != nullptr; b = b->prev) {
+	    result += b->size;
+	}
+
+	return result;
+    }
+
+ private:
+    block* m_head = nullptr;
+    std::byte* m_current = nullptr;
+    std::byte* m_end = nullptr;
+    std::size_t m_next_block_size;
+
+    bool owns(const block* target) const noexcept {
+	for (block* b = m_head; b != nullptr; b = b->prev) {
+	    if (b == target) {
+		return true;
+	    }
+	}
+
+	return false;
+    }
+
+    static std::byte* block_begin(block* b) noexcept {
+	return reinterpret_cast<std::byte*>(b) + header_size;
+    }
+
+    static std::byte* block_end(block* b) noexcept {
+	return reinterpret_cast<std::byte*>(b) + header_size + b->size;
+    }
+
+    static std::byte* align(std::byte* ptr, std::size_t alignment) noexcept {
+	const auto address = reinterpret_cast<std::uintptr_t>(ptr);
+	const auto aligned = (address + alignment - 1) & ~static_cast<std::uintptr_t>(alignment - 1);
+
+	return ptr == nullptr ? nullptr : ptr + (aligned - address);
+    }
+
+    void add_block(std::size_t bytes, std::size_t alignment) {
+	if (UMLAUT_UNLIKELY(bytes > std::numeric_limits<std::size_t>::max() / 2 - header_size - alignment)) {
+	    throw std::bad_alloc();
+	}
+
+	const std::size_t needed = bytes + alignment;
+	const std::size_t size = needed > m_next_block_size ? needed : m_next_block_size;
+
+	auto b = static_cast<block*>(::operator new(header_size + size));
+	b->prev = m_head;
+	b->size = size;
+
+	m_head = b;
+	m_current = block_begin(b);
+	m_end = block_end(b);
+	m_next_block_size = size * 2;
+    }
+
+    void free_blocks(block* last) noexcept {
+	while (m_head != last) {
+	    block* prev = m_head->prev;
+	    ::operator delete(m_head);
+	    m_head = prev;
+	}
+    }
+};
+
+/// @brief Allocator allocating from a ul::monotonic_arena.
+///
+/// Only stores a pointer to the arena, so it adds a single pointer to containers such
+/// as ul::small_vector_base. Deallocation is a no-op unless it is the most recent
+/// allocation of the arena, the memory is otherwise reclaimed when the arena is rewound.
+template <typename T>
+class arena_allocator {
+ public:
+    using value_type = T;
+
+    arena_allocator(monotonic_arena& arena) noexcept : m_arena(&arena) {}
+
+    template <typename U>
+    arena_allocator(const arena_allocator<U>& other) noexcept : m_arena(other.arena()) {}
+
+    T* allocate(std::size_t n) {
+	if (UMLAUT_UNLIKELY(n > std::numeric_limits<std::size_t>::max() / sizeof(T))) {
+	    throw std::bad_array_new_length();
+	}
+
+	return static_cast<T*>(m_arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* ptr, std::size_t n) noexcept {
+	m_arena->deallocate(ptr, n * sizeof(T));
+    }
+
+    /// @brief Returns the arena the allocator allocates from.
+    monotonic_arena* arena() const noexcept { return m_arena; }
+
+ private:
+    monotonic_arena* m_arena;
+};
+
+template <typename T, typename U>
+bool operator==(const arena_allocator<T>& lhs, const arena_allocator<U>& rhs) noexcept {
+    return lhs.arena() == rhs.arena();
+}
+
+template <typename T, typename U>
+bool operator!=(const arena_allocator<T>& lhs, const arena_allocator<U>& rhs) noexcept {
+    return lhs.arena() != rhs.arena();
+}
+
+} // namespace ul
@@ -10,6 +10,7 @@
 
 #include <utility>
 #include <cstddef>
+#include <type_traits>
 
 namespace ul {
 namespace detail {
@@ -60,6 +61,10 @@ class compressed_pair : private detail::compressed_element<First, 0>,
     using first_type = typename first_base::value_type;
     using second_type = typename second_base::value_type;
 
+    /// @brief A `compressed_pair` can be relocated with `memcpy` if both of its members can.
+    using is_trivially_relocatable = std::conjunction<ul::is_trivially_relocatable<First>,
+						      ul::is_trivially_relocatable<Second>>;
+
     constexpr compressed_pair() : first_base(), second_base() {}
 
     template <typename T = First, typename U = Second>
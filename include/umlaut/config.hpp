@@ -7,6 +7,9 @@
 
 #pragma once
 
+#include <cstdio>
+#include <cstdlib>
+
 #if defined(__has_builtin)
 #define UMLAUT_HAS_BUILTIN(x) __has_builtin(x)
 #else
@@ -20,3 +23,71 @@
 #define UMLAUT_UNLIKELY(x) (x)
 #define UMLAUT_LIKELY(x) (x)
 #endif
+
+#if defined(__GNUC__)
+#define UMLAUT_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define UMLAUT_ALWAYS_INLINE inline
+#endif
+
+/// Growth factor of ul::small_vector_base expressed as the fraction
+/// `UMLAUT_GROWTH_FACTOR_NUM / UMLAUT_GROWTH_FACTOR_DEN`, f.e. 3 / 2 for 1.5.
+#if !defined(UMLAUT_GROWTH_FACTOR_NUM)
+#define UMLAUT_GROWTH_FACTOR_NUM 2
+#endif
+
+#if !defined(UMLAUT_GROWTH_FACTOR_DEN)
+#define UMLAUT_GROWTH_FACTOR_DEN 1
+#endif
+
+/// Size in bytes from which ul::reallocating_allocator maps memory directly from the
+/// kernel, so that growing it is a `mremap` of the pages rather than a copy.
+#if !defined(UMLAUT_MREMAP_THRESHOLD)
+#define UMLAUT_MREMAP_THRESHOLD (1 << 20)
+#endif
+
+/// Size in bytes from which ul::huge_page_allocator allocates huge page aligned memory
+/// and advises the kernel to back it with transparent huge pages.
+#if !defined(UMLAUT_HUGE_PAGE_THRESHOLD)
+#define UMLAUT_HUGE_PAGE_THRESHOLD (1 << 21)
+#endif
+
+/// Enables recording of allocation statistics of ul::small_vector_base per construction
+/// site, see stats.hpp. Disabled by default, in which case it has no cost at all.
+#if !defined(UMLAUT_ENABLE_STATS)
+#define UMLAUT_ENABLE_STATS 0
+#endif
+
+/// Prints the statistics recorded with `UMLAUT_ENABLE_STATS` to `stderr` at exit.
+#if !defined(UMLAUT_STATS_DUMP_AT_EXIT)
+#define UMLAUT_STATS_DUMP_AT_EXIT 1
+#endif
+
+/// Enables the precondition checks of unchecked operations such as
+/// ul::small_vector_base::emplace_back_unchecked(). Enabled by default unless `NDEBUG`
+/// is defined.
+#if !defined(UMLAUT_ENABLE_ASSERTS)
+#if defined(NDEBUG)
+#define UMLAUT_ENABLE_ASSERTS 0
+#else
+#define UMLAUT_ENABLE_ASSERTS 1
+#endif
+#endif
+
+#if UMLAUT_ENABLE_ASSERTS
+#define UMLAUT_ASSERT(cond, msg) \
+    (UMLAUT_LIKELY(cond) ? (void)0 : (std::fprintf(stderr, "%s:%d: %s\n", __FILE__, __LINE__, msg), \
+				      std::abort()))
+#else
+#define UMLAUT_ASSERT(cond, msg) ((void)0)
+#endif
+
+/// Enables the SSE2/AVX2 kernels of ul::find(), ul::count() and ul::contains() on x86-64
+/// with GCC and Clang. The AVX2 kernels are selected at runtime based on the CPU.
+#if !defined(UMLAUT_ENABLE_SIMD)
+#if defined(__x86_64__) && defined(__GNUC__)
+#define UMLAUT_ENABLE_SIMD 1
+#else
+#define UMLAUT_ENABLE_SIMD 0
+#endif
+#endif
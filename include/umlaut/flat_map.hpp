@@ -0,0 +1,445 @@
+/// @file
+/// Defines ul::flat_map and ul::flat_set.
+///
+/// @copyright Marcus Larsson 2018
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "compressed_pair.hpp"
+#include "small_vector.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace ul {
+
+/// @brief Disambiguator tag.
+///
+/// Empty struct tag type used to indicate that a range is sorted and free of
+/// duplicates, which lets ul::flat_map and ul::flat_set skip sorting it.
+struct sorted_unique_t {
+    struct do_not_use {};
+    constexpr explicit sorted_unique_t(do_not_use) noexcept {}
+};
+
+/// @relates sorted_unique_t
+/// @brief Instance of the disambiguator tag ul::sorted_unique_t.
+inline constexpr sorted_unique_t sorted_unique{sorted_unique_t::do_not_use{}};
+
+namespace detail {
+
+struct key_of_identity {
+    template <typename T>
+    constexpr const T& operator()(const T& value) const noexcept { return value; }
+};
+
+struct key_of_first {
+    template <typename Pair>
+    constexpr const auto& operator()(const Pair& value) const noexcept { return value.first; }
+};
+
+template <typename Compare, typename = void>
+inline constexpr bool is_transparent_v = false;
+
+template <typename Compare>
+inline constexpr bool is_transparent_v<Compare, std::void_t<typename Compare::is_transparent>> = true;
+
+/// Returns the first element in `[first, first + n)` whose key is not less than `key`.
+///
+/// Halves the range with a conditional move instead of a branch, so the loop runs
+/// `log2(n)` times regardless of the result and never mispredicts.
+template <typename It, typename K, typename Compare, typename KeyOf>
+It branchless_lower_bound(It first, std::size_t n, const K& key, const Compare& comp, KeyOf key_of) {
+    if (n == 0) {
+	return first;
+    }
+
+    while (n > 1) {
+	const std::size_t half = n / 2;
+	first = comp(key_of(first[half]), key) ? first + half : first;
+	n -= half;
+    }
+
+    return first + static_cast<std::size_t>(comp(key_of(*first), key));
+}
+
+/// Sorted vector of unique keys shared by ul::flat_set and ul::flat_map.
+template <typename Key, typename Value, typename KeyOf, std::size_t N, typename Compare, typename Alloc>
+class flat_tree {
+    using container_type = small_vector<Value, N, Alloc>;
+
+public:
+    /// @name Aliases
+    /// @{
+    using key_type = Key;
+    using value_type = Value;
+    using key_compare = Compare;
+    using allocator_type = Alloc;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using iterator = std::conditional_t<std::is_same_v<Key, Value>, const value_type*, value_type*>;
+    using const_iterator = const value_type*;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+    /// @}
+
+    explicit flat_tree(const key_compare& comp = key_compare{},
+		       const allocator_type& alloc = allocator_type{} UMLAUT_CALL_SITE_PARAM)
+	: m_values_and_comp(container_type(alloc UMLAUT_CALL_SITE_ARG), comp) {}
+
+    /// @brief Constructs the container from the elements in `[first, last)`.
+    ///
+    /// Of several elements with equivalent keys only one is inserted, which one is
+    /// unspecified.
+    template <typename InputIt, typename = enable_if_iterator_t<InputIt>>
+    flat_tree(InputIt first, InputIt last, const key_compare& comp = key_compare{},
+	      const allocator_type& alloc = allocator_type{} UMLAUT_CALL_SITE_PARAM)
+	: flat_tree(comp, alloc UMLAUT_CALL_SITE_ARG) {
+	insert(first, last);
+    }
+
+    /// @brief Constructs the container from the sorted and unique elements in `[first, last)`.
+    template <typename InputIt, typename = enable_if_iterator_t<InputIt>>
+    flat_tree(sorted_unique_t, InputIt first, InputIt last, const key_compare& comp = key_compare{},
+	      const allocator_type& alloc = allocator_type{} UMLAUT_CALL_SITE_PARAM)
+	: flat_tree(comp, alloc UMLAUT_CALL_SITE_ARG) {
+	m_values().append(first, last);
+    }
+
+    /// @brief Returns the function object comparing keys.
+    key_compare key_comp() const { return m_comp(); }
+
+    /// @brief Returns the allocator associated with the container.
+    allocator_type get_allocator() const noexcept { return m_values().get_allocator(); }
+
+    /// @name Iterators
+    /// @{
+    iterator begin() noexcept { return m_values().begin(); }
+    const_iterator cbegin() const noexcept { return m_values().cbegin(); }
+    const_iterator begin() const noexcept { return m_values().begin(); }
+    iterator end() noexcept { return m_values().end(); }
+    const_iterator cend() const noexcept { return m_values().cend(); }
+    const_iterator end() const noexcept { return m_values().end(); }
+    reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator crend() const noexcept { return const_reverse_iterator(begin()); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+    /// @}
+
+    /// @name Capacity
+    /// @{
+    size_type size() const noexcept { return m_values().size(); }
+    size_type capacity() const noexcept { return m_values().capacity(); }
+    bool empty() const noexcept { return m_values().empty(); }
+    void reserve(size_type new_cap) { m_values().reserve(new_cap); }
+    void shrink_to_fit() { m_values().shrink_to_fit(); }
+    /// @}
+
+    /// @name Modifiers
+    /// @{
+
+    /// @brief Inserts `value` unless an element with an equivalent key exists.
+    /// @return Iterator to the element with the key of `value` and whether it was inserted.
+    std::pair<iterator, bool> insert(const value_type& value) { return insert_unique(value); }
+
+    /// @brief Overload taking an rvalue reference.
+    std::pair<iterator, bool> insert(value_type&& value) { return insert_unique(std::move(value)); }
+
+    /// @brief Constructs an element from `args` and inserts it, see flat_tree::insert().
+    template <typename ...Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+	return insert_unique(value_type(std::forward<Args>(args)...));
+    }
+
+    /// @brief Inserts the elements in `[first, last)`.
+    ///
+    /// The elements are appended, sorted and merged with the existing ones in a single
+    /// pass, which is linear in the size of the container rather than one insertion
+    /// per element. Existing elements are kept over new ones with equivalent keys.
+    template <typename InputIt, typename = enable_if_iterator_t<InputIt>>
+    void insert(InputIt first, InputIt last) {
+	const size_type old_size = size();
+	m_values().append(first, last);
+
+	std::sort(m_values().begin() + old_size, m_values().end(), value_comp());
+	merge_unique(old_size);
+    }
+
+    /// @brief Inserts the sorted and unique elements in `[first, last)` without sorting them.
+    template <typename InputIt, typename = enable_if_iterator_t<InputIt>>
+    void insert(sorted_unique_t, InputIt first, InputIt last) {
+	const size_type old_size = size();
+	m_values().append(first, last);
+
+	merge_unique(old_size);
+    }
+
+    /// @brief Removes the element at `pos`.
+    iterator erase(const_iterator pos) { return m_values().erase(pos); }
+
+    /// @brief Removes the elements in `[first, last)`.
+    iterator erase(const_iterator first, const_iterator last) { return m_values().erase(first, last); }
+
+    /// @brief Removes the element with key `key` if there is one.
+    /// @return The number of removed elements.
+    size_type erase(const key_type& key) {
+	const_iterator it = find(key);
+
+	if (it == end()) {
+	    return 0;
+	}
+
+	m_values().erase(it);
+	return 1;
+    }
+
+    void clear() noexcept { m_values().clear(); }
+    /// @}
+
+    /// @name Lookup
+    /// Lookup with types other than `key_type` requires a transparent `key_compare`.
+    /// @{
+
+    /// @brief Returns an iterator to the first element whose key is not less than `key`.
+    iterator lower_bound(const key_type& key) { return lower_bound_impl(key); }
+    const_iterator lower_bound(const key_type& key) const { return lower_bound_impl(key); }
+
+    template <typename K, typename C = Compare, typename = std::enable_if_t<is_transparent_v<C>>>
+    iterator lower_bound(const K& key) { return lower_bound_impl(key); }
+
+    template <typename K, typename C = Compare, typename = std::enable_if_t<is_transparent_v<C>>>
+    const_iterator lower_bound(const K& key) const { return lower_bound_impl(key); }
+
+    /// @brief Returns an iterator to the first element whose key is greater than `key`.
+    iterator upper_bound(const key_type& key) { return upper_bound_impl(key); }
+    const_iterator upper_bound(const key_type& key) const { return upper_bound_impl(key); }
+
+    template <typename K, typename C = Compare, typename = std::enable_if_t<is_transparent_v<C>>>
+    iterator upper_bound(const K& key) { return upper_bound_impl(key); }
+
+    template <typename K, typename C = Compare, typename = std::enable_if_t<is_transparent_v<C>>>
+    const_iterator upper_bound(const K& key) const { return upper_bound_impl(key); }
+
+    /// @brief Returns an iterator to the element with key `key`, or `end()` if there is none.
+    iterator find(const key_type& key) { return find_impl(key); }
+    const_iterator find(const key_type& key) const { return find_impl(key); }
+
+    template <typename K, typename C = Compare, typename = std::enable_if_t<is_transparent_v<C>>>
+    iterator find(const K& key) { return find_impl(key); }
+
+    template <typename K, typename C = Compare, typename = std::enable_if_t<is_transparent_v<C>>>
+    const_iterator find(const K& key) const { return find_impl(key); }
+
+    /// @brief Returns whether there is an element with key `key`.
+    bool contains(const key_type& key) const { return find_impl(key) != end(); }
+
+    template <typename K, typename C = Compare, typename = std::enable_if_t<is_transparent_v<C>>>
+    bool contains(const K& key) const { return find_impl(key) != end(); }
+
+    /// @brief Returns the number of elements with key `key`, which is either 0 or 1.
+    size_type count(const key_type& key) const { return contains(key) ? 1 : 0; }
+
+    template <typename K, typename C = Compare, typename = std::enable_if_t<is_transparent_v<C>>>
+    size_type count(const K& key) const { return contains(key) ? 1 : 0; }
+    /// @}
+
+ protected:
+    container_type& m_values() noexcept { return m_values_and_comp.first(); }
+    const container_type& m_values() const noexcept { return m_values_and_comp.first(); }
+
+    const key_compare& m_comp() const noexcept { return m_values_and_comp.second(); }
+
+    auto value_comp() const {
+	return [this](const value_type& lhs, const value_type& rhs) {
+	    return m_comp()(KeyOf{}(lhs), KeyOf{}(rhs));
+	};
+    }
+
+    template <typename K>
+    bool is_equivalent(const value_type& value, const K& key) const {
+	return !m_comp()(key, KeyOf{}(value));
+    }
+
+    template <typename K>
+    value_type* lower_bound_impl(const K& key) const {
+	auto first = const_cast<value_type*>(m_values().data());
+	return branchless_lower_bound(first, size(), key, m_comp(), KeyOf{});
+    }
+
+    template <typename K>
+    value_type* upper_bound_impl(const K& key) const {
+	value_type* it = lower_bound_impl(key);
+	return it != m_values().end() && is_equivalent(*it, key) ? it + 1 : it;
+    }
+
+    template <typename K>
+    value_type* find_impl(const K& key) const {
+	value_type* it = lower_bound_impl(key);
+	return it != m_values().end() && is_equivalent(*it, key) ? it : const_cast<value_type*>(m_values().end());
+    }
+
+    template <typename V>
+    std::pair<iterator, bool> insert_unique(V&& value) {
+	value_type* it = lower_bound_impl(KeyOf{}(value));
+
+	if (it != m_values().end() && is_equivalent(*it, KeyOf{}(value))) {
+	    return {it, false};
+	}
+
+	return {m_values().insert(it, std::forward<V>(value)), true};
+    }
+
+    /// @brief Merges the sorted elements from `old_size` with the ones before them and
+    /// removes the new elements whose keys already exist.
+    void merge_unique(size_type old_size) {
+	auto first = m_values().begin();
+	auto last = m_values().end();
+
+	if (old_size > 0 && old_size < size()) {
+	    std::inplace_merge(first, first + old_size, last, value_comp());
+	}
+
+	// the merge is stable, so of two equivalent elements the existing one comes first
+	auto equivalent = [this](const value_type& lhs, const value_type& rhs) {
+	    return !m_comp()(KeyOf{}(lhs), KeyOf{}(rhs));
+	};
+
+	m_values().erase(std::unique(first, last, equivalent), last);
+    }
+
+ private:
+    compressed_pair<container_type, key_compare> m_values_and_comp;
+};
+
+template <typename Key, typename Value, typename KeyOf, std::size_t N, typename Compare, typename Alloc>
+bool operator==(const flat_tree<Key, Value, KeyOf, N, Compare, Alloc>& lhs,
+		const flat_tree<Key, Value, KeyOf, N, Compare, Alloc>& rhs) {
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <typename Key, typename Value, typename KeyOf, std::size_t N, typename Compare, typename Alloc>
+bool operator!=(const flat_tree<Key, Value, KeyOf, N, Compare, Alloc>& lhs,
+		const flat_tree<Key, Value, KeyOf, N, Compare, Alloc>& rhs) {
+    return !(lhs == rhs);
+}
+
+} // namespace detail
+
+/// @brief Set of unique keys stored sorted in a ul::small_vector.
+///
+/// The first `N` keys are stored inline. Lookup is a branchless binary search over
+/// contiguous memory and bulk insertion merges the new keys in a single pass. Inserting
+/// or erasing single keys is linear, which for small sets is still faster than the node
+/// allocations of `std::set`.
+template <typename Key, std::size_t N, typename Compare = std::less<Key>,
+	  typename Alloc = std::allocator<Key>>
+class flat_set : public detail::flat_tree<Key, Key, detail::key_of_identity, N, Compare, Alloc> {
+    using base = detail::flat_tree<Key, Key, detail::key_of_identity, N, Compare, Alloc>;
+
+public:
+    using typename base::key_compare;
+    using typename base::allocator_type;
+
+    using base::base;
+
+    /// @brief Constructs an empty set.
+    ///
+    /// Declared rather than inherited so that the statistics enabled by
+    /// `UMLAUT_ENABLE_STATS` are recorded at its caller.
+    explicit flat_set(const key_compare& comp = key_compare{},
+		      const allocator_type& alloc = allocator_type{} UMLAUT_CALL_SITE_PARAM)
+	: base(comp, alloc UMLAUT_CALL_SITE_ARG) {}
+};
+
+/// @brief Map with unique keys stored as pairs sorted by key in a ul::small_vector.
+///
+/// Has the same properties as ul::flat_set. The elements are `std::pair<Key, T>` rather
+/// than `std::pair<const Key, T>` so that they can be relocated, the key of an element
+/// must not be modified through an iterator.
+template <typename Key, typename T, std::size_t N, typename Compare = std::less<Key>,
+	  typename Alloc = std::allocator<std::pair<Key, T>>>
+class flat_map : public detail::flat_tree<Key, std::pair<Key, T>, detail::key_of_first, N, Compare, Alloc> {
+    using base = detail::flat_tree<Key, std::pair<Key, T>, detail::key_of_first, N, Compare, Alloc>;
+
+public:
+    using mapped_type = T;
+    using typename base::key_type;
+    using typename base::iterator;
+    using typename base::key_compare;
+    using typename base::allocator_type;
+
+    using base::base;
+
+    /// @brief Constructs an empty map, see ul::flat_set::flat_set().
+    explicit flat_map(const key_compare& comp = key_compare{},
+		      const allocator_type& alloc = allocator_type{} UMLAUT_CALL_SITE_PARAM)
+	: base(comp, alloc UMLAUT_CALL_SITE_ARG) {}
+
+    /// @brief Returns the value mapped to `key`, inserting a value initialized one if
+    /// there is none.
+    mapped_type& operator[](const key_type& key) { return try_emplace(key).first->second; }
+
+    /// @brief Overload taking an rvalue reference.
+    mapped_type& operator[](key_type&& key) { return try_emplace(std::move(key)).first->second; }
+
+    /// @brief Returns the value mapped to `key`.
+    /// @throws std::out_of_range if there is no element with key `key`.
+    mapped_type& at(const key_type& key) {
+	return const_cast<mapped_type&>(std::as_const(*this).at(key));
+    }
+
+    /// @brief Const overload of flat_map::at().
+    const mapped_type& at(const key_type& key) const {
+	auto it = this->find(key);
+
+	if (it == this->end()) {
+	    throw std::out_of_range("flat_map::at");
+	}
+
+	return it->second;
+    }
+
+    /// @brief Inserts a value constructed from `args` if there is no element with key `key`.
+    ///
+    /// Unlike flat_map::emplace() nothing is constructed if the key exists.
+    template <typename K, typename ...Args>
+    std::pair<iterator, bool> try_emplace(K&& key, Args&&... args) {
+	auto it = this->lower_bound_impl(key);
+
+	if (it != this->end() && this->is_equivalent(*it, key)) {
+	    return {it, false};
+	}
+
+	it = this->m_values().emplace(it, std::piecewise_construct,
+				      std::forward_as_tuple(std::forward<K>(key)),
+				      std::forward_as_tuple(std::forward<Args>(args)...));
+	return {it, true};
+    }
+
+    /// @brief Assigns `value` to the element with key `key` or inserts it if there is none.
+    template <typename K, typename M>
+    std::pair<iterator, bool> insert_or_assign(K&& key, M&& value) {
+	auto result = try_emplace(std::forward<K>(key), std::forward<M>(value));
+
+	if (!result.second) {
+	    result.first->second = std::forward<M>(value);
+	}
+
+	return result;
+    }
+};
+
+} // namespace ul
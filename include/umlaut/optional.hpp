@@ -8,13 +8,17 @@
 
 #pragma once
 
+#include "config.hpp"
 #include "special_members.hpp"
 #include "traits.hpp"
 
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <exception>
 #include <functional>
 #include <memory>
+#include <tuple>
 #include <type_traits>
 #include <utility>
 
@@ -54,6 +58,111 @@ class bad_optional_access : public std::exception {
     }
 };
 
+/// @brief Customization point letting ul::optional store its empty state inside `T`.
+///
+/// By default an optional keeps a `bool` next to the value, which padding usually
+/// turns into as many bytes as the alignment of `T`. A specialization defining
+/// `has_sentinel` as `true` instead reserves one value of `T` to mean "empty":
+///
+/// - `static T empty_value() noexcept` returns the reserved value.
+/// - `static bool is_empty(const T&) noexcept` returns whether a value is the
+///   reserved one.
+///
+/// The optional is then exactly as large as `T`, but can no longer hold the reserved
+/// value, which is checked by `UMLAUT_ASSERT`. `T` must be trivially copyable. No type
+/// has a sentinel unless it is specialized, see ul::optional_sentinel_traits,
+/// ul::optional_pointer_traits and ul::optional_nan_traits for common choices. An
+/// optional with a sentinel is only usable in constant expressions if the
+/// specialization's functions are `constexpr`.
+template <typename T>
+struct optional_traits {
+    static constexpr bool has_sentinel = false;
+};
+
+/// @brief ul::optional_traits reserving the value `Sentinel` of an enum or integer type.
+///
+/// @code
+/// enum class color : std::uint8_t { red, green, blue };
+///
+/// template <>
+/// struct ul::optional_traits<color> : ul::optional_sentinel_traits<color, color{0xff}> {};
+/// @endcode
+template <typename T, T Sentinel>
+struct optional_sentinel_traits {
+    static constexpr bool has_sentinel = true;
+
+    static constexpr T empty_value() noexcept { return Sentinel; }
+    static constexpr bool is_empty(const T& value) noexcept {
+        return value == Sentinel;
+    }
+};
+
+/// @brief ul::optional_traits for `T*` reserving the address with all bits set,
+/// which no object can have.
+///
+/// @code
+/// template <>
+/// struct ul::optional_traits<node*> : ul::optional_pointer_traits<node> {};
+/// @endcode
+template <typename T>
+struct optional_pointer_traits {
+    static constexpr bool has_sentinel = true;
+
+    static T* empty_value() noexcept {
+        return reinterpret_cast<T*>(~std::uintptr_t{0});
+    }
+
+    static bool is_empty(T* const& value) noexcept {
+        return reinterpret_cast<std::uintptr_t>(value) == ~std::uintptr_t{0};
+    }
+};
+
+namespace detail {
+
+template <std::size_t Size>
+struct nan_pattern;
+
+template <>
+struct nan_pattern<4> {
+    using type = std::uint32_t;
+    static constexpr type value = 0x7fc0'dead;
+};
+
+template <>
+struct nan_pattern<8> {
+    using type = std::uint64_t;
+    static constexpr type value = 0x7ff8'dead'beef'0001;
+};
+
+}  // namespace detail
+
+/// @brief ul::optional_traits reserving a quiet NaN with a payload no arithmetic
+/// produces, for `float`, `double` or a type holding only one of them.
+///
+/// The bits are compared, so every other NaN can still be stored.
+template <typename T>
+struct optional_nan_traits {
+    static_assert(sizeof(T) == 4 || sizeof(T) == 8,
+                  "T must be as large as a float or a double");
+
+    using bits = typename detail::nan_pattern<sizeof(T)>::type;
+
+    static constexpr bool has_sentinel = true;
+
+    static T empty_value() noexcept {
+        const bits pattern = detail::nan_pattern<sizeof(T)>::value;
+        T value;
+        std::memcpy(&value, &pattern, sizeof(T));
+        return value;
+    }
+
+    static bool is_empty(const T& value) noexcept {
+        bits pattern;
+        std::memcpy(&pattern, &value, sizeof(T));
+        return pattern == detail::nan_pattern<sizeof(T)>::value;
+    }
+};
+
 namespace detail {
 
 template <typename T, typename U>
@@ -93,8 +202,12 @@ using enable_forward_value_t =
     std::enable_if_t<!std::is_same_v<remove_cvref_t<U>, std::in_place_t> &&
                      !std::is_same_v<remove_cvref_t<U>, optional<T>>>;
 
-template <typename T, bool = std::is_trivially_destructible_v<T>>
+template <typename T, bool = std::is_trivially_destructible_v<T>,
+          bool = optional_traits<T>::has_sentinel>
 struct optional_maybe_dtor {
+    static_assert(!optional_traits<T>::has_sentinel,
+                  "types with an optional sentinel must be trivially destructible");
+
     using value_type = T;
 
     constexpr optional_maybe_dtor() noexcept : m_dummy(), m_has_value(false) {}
@@ -107,6 +220,9 @@ struct optional_maybe_dtor {
         if (m_has_value) m_value.~value_type();
     }
 
+    constexpr bool has_value() const noexcept { return m_has_value; }
+    constexpr void engage() noexcept { m_has_value = true; }
+
     void destroy() noexcept {
         if (m_has_value) {
             m_value.~value_type();
@@ -124,7 +240,7 @@ struct optional_maybe_dtor {
 };
 
 template <typename T>
-struct optional_maybe_dtor<T, true> {
+struct optional_maybe_dtor<T, true, false> {
     using value_type = T;
 
     constexpr optional_maybe_dtor() noexcept : m_dummy(), m_has_value(false) {}
@@ -133,6 +249,9 @@ struct optional_maybe_dtor<T, true> {
     constexpr explicit optional_maybe_dtor(std::in_place_t, Args&&... args)
         : m_value(std::forward<Args>(args)...), m_has_value(true) {}
 
+    constexpr bool has_value() const noexcept { return m_has_value; }
+    constexpr void engage() noexcept { m_has_value = true; }
+
     void destroy() noexcept {
         if (m_has_value) m_has_value = false;
     }
@@ -146,6 +265,38 @@ struct optional_maybe_dtor<T, true> {
     bool m_has_value;
 };
 
+/// Storage without an engaged flag, the empty state is the sentinel value of
+/// ul::optional_traits stored in place of the value.
+template <typename T>
+struct optional_maybe_dtor<T, true, true> {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "types with an optional sentinel must be trivially copyable");
+
+    using value_type = T;
+    using traits = optional_traits<T>;
+
+    constexpr optional_maybe_dtor() noexcept : m_value(traits::empty_value()) {}
+
+    template <typename... Args>
+    constexpr explicit optional_maybe_dtor(std::in_place_t, Args&&... args)
+        : m_value(std::forward<Args>(args)...) {
+        engage();
+    }
+
+    constexpr bool has_value() const noexcept {
+        return !traits::is_empty(m_value);
+    }
+
+    constexpr void engage() const noexcept {
+        UMLAUT_ASSERT(!traits::is_empty(m_value),
+                      "the optional sentinel value cannot be stored");
+    }
+
+    void destroy() noexcept { m_value = traits::empty_value(); }
+
+    value_type m_value;
+};
+
 template <typename T>
 struct optional_storage_base : optional_maybe_dtor<T> {
     using value_type = T;
@@ -155,27 +306,36 @@ struct optional_storage_base : optional_maybe_dtor<T> {
     void construct(Args&&... args) {
         ::new (std::addressof(this->m_value))
             value_type(std::forward<Args>(args)...);
-        this->m_has_value = true;
+        this->engage();
     }
 
-    constexpr bool has_value() const noexcept { return this->m_has_value; }
-
     template <typename U>
     void construct_from(U&& other) {
-        if (other.has_value()) construct(*std::forward<U>(other));
+        if (other.has_value()) construct(value_of(std::forward<U>(other)));
     }
 
     template <typename U>
     void assign_from(U&& other) {
-        if (has_value() == other.has_value()) {
-            if (has_value()) this->m_value = *std::forward<U>(other);
+        if (this->has_value() == other.has_value()) {
+            if (this->has_value())
+                this->m_value = value_of(std::forward<U>(other));
         } else {
-            if (has_value())
+            if (this->has_value())
                 this->destroy();
             else
-                construct(*std::forward<U>(other));
+                construct(value_of(std::forward<U>(other)));
         }
     }
+
+    /// Returns the value of another optional, or of the storage of one when called
+    /// from the special members of the bases below.
+    template <typename U>
+    static constexpr decltype(auto) value_of(U&& other) noexcept {
+        if constexpr (is_optional_v<U>)
+            return *std::forward<U>(other);
+        else
+            return (std::forward<U>(other).m_value);
+    }
 };
 
 template <typename T, bool = std::is_trivially_copy_constructible_v<T>>
@@ -292,6 +452,10 @@ class optional : private detail::optional_move_assign_base<T>,
    public:
     using value_type = T;
 
+    /// @brief An `optional` can be relocated with `memcpy` if its value can, the
+    /// engaged flag or sentinel is relocated along with it.
+    using is_trivially_relocatable = ul::is_trivially_relocatable<T>;
+
     constexpr optional() noexcept = default;
 
     constexpr optional(nullopt_t) noexcept {}
@@ -412,10 +576,10 @@ class optional : private detail::optional_move_assign_base<T>,
     constexpr const value_type* operator->() const { return &this->m_value; }
 
     constexpr explicit operator bool() const noexcept {
-        return this->m_has_value;
+        return base::has_value();
     }
 
-    constexpr bool has_value() const noexcept { return this->m_has_value; }
+    constexpr bool has_value() const noexcept { return base::has_value(); }
 
     constexpr value_type& value() & {
         if (has_value()) return this->m_value;
@@ -637,6 +801,127 @@ class optional : private detail::optional_move_assign_base<T>,
     }
 };
 
+/// @brief Optional reference, stored as a single pointer which is null when empty.
+///
+/// Lets lookup functions return an element without copying it while keeping the
+/// monadic interface of ul::optional. Like a pointer, and unlike a reference, assigning
+/// to an `optional<T&>` rebinds it rather than assigning through it, and it can only
+/// be bound to lvalues.
+template <typename T>
+class optional<T&> {
+   public:
+    using value_type = T&;
+
+    constexpr optional() noexcept = default;
+
+    constexpr optional(nullopt_t) noexcept {}
+
+    constexpr optional(const optional& rhs) noexcept = default;
+
+    template <typename U,
+              std::enable_if_t<std::is_convertible_v<U&, T&>>* = nullptr>
+    constexpr optional(U& ref) noexcept : m_ptr(std::addressof(ref)) {}
+
+    template <typename U,
+              std::enable_if_t<std::is_convertible_v<U&, T&>>* = nullptr>
+    constexpr optional(const optional<U&>& other) noexcept
+        : m_ptr(other.has_value() ? std::addressof(*other) : nullptr) {}
+
+    optional& operator=(nullopt_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    optional& operator=(const optional& rhs) noexcept = default;
+
+    /// @brief Rebinds the optional to `ref`.
+    template <typename U,
+              std::enable_if_t<std::is_convertible_v<U&, T&>>* = nullptr>
+    optional& operator=(U& ref) noexcept {
+        m_ptr = std::addressof(ref);
+        return *this;
+    }
+
+    constexpr T& operator*() const noexcept { return *m_ptr; }
+    constexpr T* operator->() const noexcept { return m_ptr; }
+
+    constexpr explicit operator bool() const noexcept {
+        return m_ptr != nullptr;
+    }
+
+    constexpr bool has_value() const noexcept { return m_ptr != nullptr; }
+
+    constexpr T& value() const {
+        if (has_value()) return *m_ptr;
+
+        throw bad_optional_access{};
+    }
+
+    /// @brief Returns a copy of the referred value, or `default_value`.
+    template <typename U>
+    constexpr std::remove_cv_t<T> value_or(U&& default_value) const {
+        if (has_value()) return *m_ptr;
+
+        return static_cast<std::remove_cv_t<T>>(
+            std::forward<U>(default_value));
+    }
+
+    void swap(optional& other) noexcept { std::swap(m_ptr, other.m_ptr); }
+
+    friend void swap(optional& lhs, optional& rhs) noexcept { lhs.swap(rhs); }
+
+    void reset() noexcept { m_ptr = nullptr; }
+
+    /// @brief Rebinds the optional to `ref`.
+    template <typename U,
+              std::enable_if_t<std::is_convertible_v<U&, T&>>* = nullptr>
+    T& emplace(U& ref) noexcept {
+        m_ptr = std::addressof(ref);
+        return *m_ptr;
+    }
+
+    template <typename F>
+    constexpr auto then(F&& f) const {
+        static_assert(std::is_invocable_v<F, T&>,
+                      "F must be invocable with T&");
+
+        using result_t = std::invoke_result_t<F, T&>;
+
+        if constexpr (is_optional_v<result_t>) {
+            if (has_value()) return std::invoke(std::forward<F>(f), **this);
+
+            return result_t(nullopt);
+        } else {
+            if (has_value())
+                return optional<result_t>(
+                    std::invoke(std::forward<F>(f), **this));
+
+            return optional<result_t>(nullopt);
+        }
+    }
+
+    template <typename F>
+    constexpr auto catch_error(F&& f) const {
+        static_assert(std::is_invocable_v<F>, "F must be invocable");
+
+        using result_t = std::invoke_result_t<F>;
+
+        if (has_value()) return *this;
+
+        if constexpr (is_optional_v<result_t>) {
+            return std::invoke(std::forward<F>(f));
+        } else if constexpr (std::is_void_v<result_t>) {
+            std::invoke(std::forward<F>(f));
+            return *this;
+        } else {
+            return optional<result_t>(std::invoke(std::forward<F>(f)));
+        }
+    }
+
+   private:
+    T* m_ptr = nullptr;
+};
+
 template <typename T>
 std::enable_if_t<std::is_move_constructible_v<T> && std::is_swappable_v<T>>
 swap(optional<T>& lhs, optional<T>& rhs) noexcept(noexcept(lhs.swap(rhs))) {
@@ -860,4 +1145,311 @@ constexpr bool operator>=(const T& value, const optional<U>& opt) {
 template <typename T>
 optional(T)->optional<T>;
 
+// pipelines
+namespace detail {
+
+template <typename F>
+struct then_stage {
+    static constexpr bool on_value = true;
+    F f;
+};
+
+template <typename F>
+struct catch_error_stage {
+    static constexpr bool on_value = false;
+    F f;
+};
+
+template <typename U>
+struct value_or_stage {
+    U default_value;
+
+    template <typename Opt, std::enable_if_t<is_optional_v<Opt>>* = nullptr>
+    friend constexpr auto operator|(Opt&& opt, value_or_stage stage) {
+        return std::forward<Opt>(opt).value_or(std::move(stage.default_value));
+    }
+};
+
+/// Value type of the optional a stage returning `R` leaves behind.
+template <typename R, bool = is_optional_v<R>>
+struct stage_value {
+    using type = R;
+};
+
+template <typename R>
+struct stage_value<R, true> {
+    using type = typename remove_cvref_t<R>::value_type;
+};
+
+/// Callable type of the stage `F` when the pipeline is evaluated as `const`.
+template <bool Const, typename F>
+using stage_callable_t = std::conditional_t<Const, const F&, F&>;
+
+/// Value type of the optional that chaining the stages as members would
+/// produce, where `Arg` is what the next stage is invoked with and `E` the
+/// current value type. Has no `type` if a stage cannot be invoked.
+template <bool Const, typename Arg, typename E, typename Stages,
+          typename = void>
+struct pipeline_value {};
+
+template <bool Const, typename Arg, typename E>
+struct pipeline_value<Const, Arg, E, std::tuple<>> {
+    using type = E;
+};
+
+template <bool Const, typename Arg, typename E, typename F, typename... Stages>
+struct pipeline_value<
+    Const, Arg, E, std::tuple<then_stage<F>, Stages...>,
+    std::enable_if_t<std::is_invocable_v<stage_callable_t<Const, F>, Arg>>>
+    : pipeline_value<Const,
+                     typename stage_value<std::invoke_result_t<
+                         stage_callable_t<Const, F>, Arg>>::type&&,
+                     typename stage_value<std::invoke_result_t<
+                         stage_callable_t<Const, F>, Arg>>::type,
+                     std::tuple<Stages...>> {};
+
+template <bool Const, typename Arg, typename E, typename F, typename... Stages>
+struct pipeline_value<Const, Arg, E, std::tuple<catch_error_stage<F>, Stages...>>
+    : pipeline_value<Const, Arg, E, std::tuple<Stages...>> {};
+
+template <typename E>
+struct optional_sink {
+    using result_type = optional<E>;
+
+    template <typename A>
+    constexpr result_type engaged(A&& value) {
+        return result_type(std::forward<A>(value));
+    }
+
+    constexpr result_type empty() { return result_type(nullopt); }
+};
+
+template <typename V, typename U>
+struct value_or_sink {
+    using result_type = V;
+
+    template <typename A>
+    constexpr result_type engaged(A&& value) {
+        return static_cast<V>(std::forward<A>(value));
+    }
+
+    constexpr result_type empty() {
+        return static_cast<V>(std::forward<U>(default_value));
+    }
+
+    U&& default_value;
+};
+
+template <std::size_t I, typename Sink, typename Stages>
+constexpr typename Sink::result_type run_empty(Stages& stages, Sink& sink);
+
+// The stages are run in continuation passing style, every intermediate value
+// is a temporary of the call running the next stage rather than the value of an
+// optional.
+template <std::size_t I, typename Sink, typename Stages, typename Arg>
+constexpr typename Sink::result_type run_engaged(Stages& stages, Sink& sink,
+                                                 Arg&& arg) {
+    if constexpr (I == std::tuple_size_v<Stages>) {
+        return sink.engaged(std::forward<Arg>(arg));
+    } else {
+        auto& stage = std::get<I>(stages);
+
+        if constexpr (!remove_cvref_t<decltype(stage)>::on_value) {
+            return run_engaged<I + 1>(stages, sink, std::forward<Arg>(arg));
+        } else {
+            using result_t = std::invoke_result_t<decltype((stage.f)), Arg>;
+
+            if constexpr (is_optional_v<result_t>) {
+                auto&& result = std::invoke(stage.f, std::forward<Arg>(arg));
+
+                if (result.has_value())
+                    return run_engaged<I + 1>(
+                        stages, sink, *std::forward<result_t>(result));
+
+                return run_empty<I + 1>(stages, sink);
+            } else {
+                return run_engaged<I + 1>(
+                    stages, sink, std::invoke(stage.f, std::forward<Arg>(arg)));
+            }
+        }
+    }
+}
+
+template <std::size_t I, typename Sink, typename Stages>
+constexpr typename Sink::result_type run_empty(Stages& stages, Sink& sink) {
+    if constexpr (I == std::tuple_size_v<Stages>) {
+        return sink.empty();
+    } else {
+        auto& stage = std::get<I>(stages);
+
+        if constexpr (!remove_cvref_t<decltype(stage)>::on_value) {
+            using result_t = std::invoke_result_t<decltype((stage.f))>;
+
+            if constexpr (is_optional_v<result_t>) {
+                auto&& result = std::invoke(stage.f);
+
+                if (result.has_value())
+                    return run_engaged<I + 1>(stages, sink,
+                                              *std::forward<result_t>(result));
+            } else if constexpr (std::is_void_v<result_t>) {
+                std::invoke(stage.f);
+            } else {
+                return run_engaged<I + 1>(stages, sink, std::invoke(stage.f));
+            }
+        }
+
+        return run_empty<I + 1>(stages, sink);
+    }
+}
+
+template <typename Source, typename... Stages>
+class optional_pipeline;
+
+/// Stages composed with `operator|` but not yet applied to an optional.
+template <typename... Stages>
+struct optional_stages {
+    std::tuple<Stages...> stages;
+
+    template <typename... Others>
+    friend constexpr auto operator|(optional_stages lhs,
+                                    optional_stages<Others...> rhs) {
+        return optional_stages<Stages..., Others...>{
+            std::tuple_cat(std::move(lhs.stages), std::move(rhs.stages))};
+    }
+
+    template <typename Opt, std::enable_if_t<is_optional_v<Opt>>* = nullptr>
+    friend constexpr auto operator|(Opt&& opt, optional_stages rhs) {
+        return optional_pipeline<Opt, Stages...>(std::forward<Opt>(opt),
+                                                 std::move(rhs.stages));
+    }
+};
+
+/// An optional and the stages to run on it, evaluated when converted to an
+/// optional or finished with ul::value_or().
+///
+/// The pipeline refers to an optional it was started from as an lvalue and
+/// owns one it was started from as an rvalue, `Source` is an lvalue reference
+/// type for lvalues and the type of the optional for rvalues. Appending stages
+/// moves the stages, and the optional if it is owned.
+template <typename Source, typename... Stages>
+class optional_pipeline {
+    using source_type =
+        std::conditional_t<std::is_lvalue_reference_v<Source>, Source,
+                           remove_cvref_t<Source>>;
+
+    template <bool Const, typename S>
+    using value_t = typename pipeline_value<
+        Const, decltype(*std::declval<S&&>()),
+        typename remove_cvref_t<S>::value_type, std::tuple<Stages...>>::type;
+
+    template <typename S>
+    using enable_if_lvalue_t =
+        std::enable_if_t<std::is_lvalue_reference_v<S>>;
+
+   public:
+    constexpr optional_pipeline(Source&& source, std::tuple<Stages...> stages)
+        : m_source(std::forward<Source>(source)),
+          m_stages(std::move(stages)) {}
+
+    /// Only a pipeline started from an lvalue can be evaluated more than once.
+    template <typename S = Source, typename = enable_if_lvalue_t<S>>
+    constexpr operator optional<value_t<true, S>>() const& {
+        optional_sink<value_t<true, S>> sink;
+        return evaluate(sink, m_source, m_stages);
+    }
+
+    template <typename S = Source>
+    constexpr operator optional<value_t<false, S>>() && {
+        optional_sink<value_t<false, S>> sink;
+        return evaluate(sink, std::forward<Source>(m_source), m_stages);
+    }
+
+    template <typename U, typename S = Source,
+              typename = enable_if_lvalue_t<S>>
+    constexpr auto value_or(U&& default_value) const& {
+        value_or_sink<remove_cvref_t<value_t<true, S>>, U> sink{
+            std::forward<U>(default_value)};
+        return evaluate(sink, m_source, m_stages);
+    }
+
+    template <typename U, typename S = Source>
+    constexpr auto value_or(U&& default_value) && {
+        value_or_sink<remove_cvref_t<value_t<false, S>>, U> sink{
+            std::forward<U>(default_value)};
+        return evaluate(sink, std::forward<Source>(m_source), m_stages);
+    }
+
+    template <typename... Others>
+    friend constexpr auto operator|(optional_pipeline pipeline,
+                                    optional_stages<Others...> rhs) {
+        return optional_pipeline<Source, Stages..., Others...>(
+            std::forward<Source>(pipeline.m_source),
+            std::tuple_cat(std::move(pipeline.m_stages),
+                           std::move(rhs.stages)));
+    }
+
+    template <typename U>
+    friend constexpr auto operator|(optional_pipeline pipeline,
+                                    value_or_stage<U> stage) {
+        return std::move(pipeline).value_or(std::move(stage.default_value));
+    }
+
+   private:
+    template <typename Sink, typename Opt, typename StageTuple>
+    static constexpr typename Sink::result_type evaluate(Sink& sink,
+                                                         Opt&& source,
+                                                         StageTuple& stages) {
+        if (source.has_value())
+            return run_engaged<0>(stages, sink, *std::forward<Opt>(source));
+
+        return run_empty<0>(stages, sink);
+    }
+
+    source_type m_source;
+    std::tuple<Stages...> m_stages;
+};
+
+}  // namespace detail
+
+/// @brief Lazy form of optional::then() for use in a pipeline.
+///
+/// `opt | ul::then(f) | ul::then(g) | ul::value_or(x)` gives the same result
+/// as `opt.then(f).then(g).value_or(x)`, but nothing runs until the pipeline is
+/// converted to an optional or finished with ul::value_or(), and then the
+/// stages run in one pass. A stage returning a value hands it straight to the
+/// next stage instead of moving it into an intermediate optional, only the
+/// final result is moved into place. Stages can also be composed on their own,
+/// `auto validate = ul::then(f) | ul::then(g);`, and applied later with
+/// `opt | validate`.
+///
+/// A pipeline refers to an lvalue optional it was started from and must not
+/// outlive it. One started from an rvalue moves the optional into itself and
+/// can only be evaluated once, as an rvalue, which lets the stages take the
+/// value as an rvalue. Composing the stages before applying them,
+/// `make() | (ul::then(f) | ul::then(g))`, moves the optional only once.
+template <typename F>
+constexpr auto then(F&& f) {
+    using stage = detail::then_stage<std::decay_t<F>>;
+    return detail::optional_stages<stage>{
+        std::tuple<stage>(stage{std::forward<F>(f)})};
+}
+
+/// @brief Lazy form of optional::catch_error() for use in a pipeline.
+/// @see ul::then()
+template <typename F>
+constexpr auto catch_error(F&& f) {
+    using stage = detail::catch_error_stage<std::decay_t<F>>;
+    return detail::optional_stages<stage>{
+        std::tuple<stage>(stage{std::forward<F>(f)})};
+}
+
+/// @brief Evaluates a pipeline, or an optional, and returns its value or
+/// `default_value`.
+/// @see ul::then()
+template <typename U>
+constexpr auto value_or(U&& default_value) {
+    return detail::value_or_stage<std::decay_t<U>>{
+        std::forward<U>(default_value)};
+}
+
 }  // namespace ul
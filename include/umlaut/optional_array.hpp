@@ -0,0 +1,621 @@
+/// @file
+/// Defines ul::optional_array.
+///
+/// @copyright Marcus Larsson 2018
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "algorithm.hpp"
+#include "config.hpp"
+#include "optional.hpp"
+#include "small_vector.hpp"
+
+#include <algorithm>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace ul {
+namespace detail {
+
+/// Number of elements covered by one word of the validity bitmap of ul::optional_array.
+inline constexpr std::size_t validity_word_bits = 64;
+
+// The kernels below work on whole words of the validity bitmap, the values are padded
+// to a multiple of `validity_word_bits` so every word has 64 values behind it. Words
+// with all bits set or cleared take a plain loop, mixed words first select between the
+// value and an identity element so the loop has no branches. They are written to be
+// vectorized by the compiler and are compiled a second time for AVX2, which is
+// selected at runtime like the kernels of ul::find().
+
+UMLAUT_ALWAYS_INLINE std::size_t popcount_kernel(const std::uint64_t* words, std::size_t word_count) noexcept {
+    std::size_t result = 0;
+
+    for (std::size_t w = 0; w < word_count; ++w) {
+#if UMLAUT_HAS_BUILTIN(__builtin_popcountll) || defined(__GNUC__)
+	result += static_cast<std::size_t>(__builtin_popcountll(words[w]));
+#else
+	result += std::bitset<validity_word_bits>(words[w]).count();
+#endif
+    }
+
+    return result;
+}
+
+template <typename T>
+UMLAUT_ALWAYS_INLINE void value_or_kernel(const T* values, const std::uint64_t* words, std::size_t size,
+					  const T& default_value, T* out) {
+    // a copy since `default_value` could otherwise alias `out`
+    const T fill = default_value;
+    const std::size_t full_words = size / validity_word_bits;
+
+    for (std::size_t w = 0; w < full_words; ++w, values += validity_word_bits, out += validity_word_bits) {
+	const std::uint64_t word = words[w];
+
+	if (word == ~std::uint64_t{0}) {
+	    std::copy(values, values + validity_word_bits, out);
+	}
+	else if (word == 0) {
+	    std::fill_n(out, validity_word_bits, fill);
+	}
+	else {
+	    for (std::size_t j = 0; j < validity_word_bits; ++j) {
+		out[j] = (word >> j) & 1 ? values[j] : fill;
+	    }
+	}
+    }
+
+    for (std::size_t j = 0; j < size % validity_word_bits; ++j) {
+	out[j] = (words[full_words] >> j) & 1 ? values[j] : fill;
+    }
+}
+
+template <typename Acc, typename T>
+UMLAUT_ALWAYS_INLINE Acc masked_sum_kernel(const T* values, const std::uint64_t* words,
+					   std::size_t word_count) noexcept {
+    // independent accumulators, floating point additions are otherwise not reordered
+    constexpr std::size_t lanes = 8;
+    Acc acc[lanes] = {};
+
+    for (std::size_t w = 0; w < word_count; ++w, values += validity_word_bits) {
+	const std::uint64_t word = words[w];
+
+	if (word == ~std::uint64_t{0}) {
+	    for (std::size_t j = 0; j < validity_word_bits; j += lanes) {
+		for (std::size_t k = 0; k < lanes; ++k) {
+		    acc[k] += static_cast<Acc>(values[j + k]);
+		}
+	    }
+	}
+	else if (word != 0) {
+	    Acc masked[validity_word_bits];
+
+	    for (std::size_t j = 0; j < validity_word_bits; ++j) {
+		masked[j] = (word >> j) & 1 ? static_cast<Acc>(values[j]) : Acc{};
+	    }
+
+	    for (std::size_t j = 0; j < validity_word_bits; j += lanes) {
+		for (std::size_t k = 0; k < lanes; ++k) {
+		    acc[k] += masked[j + k];
+		}
+	    }
+	}
+    }
+
+    Acc result{};
+
+    for (std::size_t k = 0; k < lanes; ++k) {
+	result += acc[k];
+    }
+
+    return result;
+}
+
+/// Minimum (or maximum if `!IsMin`) of the engaged values, `identity` if there are none.
+/// NaN values never compare less or greater and are therefore skipped.
+template <bool IsMin, typename T>
+UMLAUT_ALWAYS_INLINE T masked_extremum_kernel(const T* values, const std::uint64_t* words,
+					      std::size_t word_count, T identity) noexcept {
+    constexpr std::size_t lanes = 8;
+    T acc[lanes];
+    std::fill_n(acc, lanes, identity);
+
+    auto pick = [](T lhs, T rhs) {
+	if constexpr (IsMin) {
+	    return rhs < lhs ? rhs : lhs;
+	}
+	else {
+	    return rhs > lhs ? rhs : lhs;
+	}
+    };
+
+    for (std::size_t w = 0; w < word_count; ++w, values += validity_word_bits) {
+	const std::uint64_t word = words[w];
+
+	if (word == ~std::uint64_t{0}) {
+	    for (std::size_t j = 0; j < validity_word_bits; j += lanes) {
+		for (std::size_t k = 0; k < lanes; ++k) {
+		    acc[k] = pick(acc[k], values[j + k]);
+		}
+	    }
+	}
+	else if (word != 0) {
+	    T masked[validity_word_bits];
+
+	    for (std::size_t j = 0; j < validity_word_bits; ++j) {
+		masked[j] = (word >> j) & 1 ? values[j] : identity;
+	    }
+
+	    for (std::size_t j = 0; j < validity_word_bits; j += lanes) {
+		for (std::size_t k = 0; k < lanes; ++k) {
+		    acc[k] = pick(acc[k], masked[j + k]);
+		}
+	    }
+	}
+    }
+
+    T result = identity;
+
+    for (std::size_t k = 0; k < lanes; ++k) {
+	result = pick(result, acc[k]);
+    }
+
+    return result;
+}
+
+#if UMLAUT_ENABLE_SIMD
+
+UMLAUT_TARGET_AVX2 inline std::size_t popcount_avx2(const std::uint64_t* words, std::size_t word_count) noexcept {
+    return popcount_kernel(words, word_count);
+}
+
+template <typename T>
+UMLAUT_TARGET_AVX2 void value_or_avx2(const T* values, const std::uint64_t* words, std::size_t size,
+				      const T& default_value, T* out) noexcept {
+    value_or_kernel(values, words, size, default_value, out);
+}
+
+template <typename Acc, typename T>
+UMLAUT_TARGET_AVX2 Acc masked_sum_avx2(const T* values, const std::uint64_t* words,
+				       std::size_t word_count) noexcept {
+    return masked_sum_kernel<Acc>(values, words, word_count);
+}
+
+template <bool IsMin, typename T>
+UMLAUT_TARGET_AVX2 T masked_extremum_avx2(const T* values, const std::uint64_t* words,
+					  std::size_t word_count, T identity) noexcept {
+    return masked_extremum_kernel<IsMin>(values, words, word_count, identity);
+}
+
+#endif // UMLAUT_ENABLE_SIMD
+
+inline std::size_t popcount(const std::uint64_t* words, std::size_t word_count) noexcept {
+#if UMLAUT_ENABLE_SIMD
+    if (cpu_has_avx2()) {
+	return popcount_avx2(words, word_count);
+    }
+#endif
+
+    return popcount_kernel(words, word_count);
+}
+
+template <typename T>
+void masked_value_or(const T* values, const std::uint64_t* words, std::size_t size,
+		     const T& default_value, T* out) {
+#if UMLAUT_ENABLE_SIMD
+    if constexpr (std::is_arithmetic_v<T>) {
+	if (cpu_has_avx2()) {
+	    value_or_avx2(values, words, size, default_value, out);
+	    return;
+	}
+    }
+#endif
+
+    value_or_kernel(values, words, size, default_value, out);
+}
+
+template <typename Acc, typename T>
+Acc masked_sum(const T* values, const std::uint64_t* words, std::size_t word_count) noexcept {
+#if UMLAUT_ENABLE_SIMD
+    if (cpu_has_avx2()) {
+	return masked_sum_avx2<Acc>(values, words, word_count);
+    }
+#endif
+
+    return masked_sum_kernel<Acc>(values, words, word_count);
+}
+
+template <bool IsMin, typename T>
+T masked_extremum(const T* values, const std::uint64_t* words, std::size_t word_count, T identity) noexcept {
+#if UMLAUT_ENABLE_SIMD
+    if (cpu_has_avx2()) {
+	return masked_extremum_avx2<IsMin>(values, words, word_count, identity);
+    }
+#endif
+
+    return masked_extremum_kernel<IsMin>(values, words, word_count, identity);
+}
+
+} // namespace detail
+
+/// @brief Array of optional values stored as a dense array of values and a validity bitmap.
+///
+/// An array of ul::optional spends up to half of its bytes on the engaged flag and its
+/// padding, and interleaving flags with values defeats vectorization. Like an Apache
+/// Arrow column, `optional_array` keeps the values contiguous with one bit per element
+/// telling whether it is engaged, so a column of `double` takes 8 bytes and a bit per
+/// row.
+///
+/// Elements are accessed through ul::optional_array::reference, which behaves like a
+/// ul::optional<T&>. Bulk operations over arithmetic values, such as
+/// optional_array::sum() and optional_array::value_or(), process 64 elements per
+/// bitmap word and use AVX2 when the CPU supports it.
+///
+/// The values are padded to a multiple of 64 elements. Disengaged elements hold a value
+/// initialized `T` or the last value assigned to them.
+template <typename T, typename Alloc = std::allocator<T>>
+class optional_array {
+    using word_type = std::uint64_t;
+    using word_allocator = typename std::allocator_traits<Alloc>::template rebind_alloc<word_type>;
+
+    static constexpr std::size_t word_bits = detail::validity_word_bits;
+
+ public:
+    /// @name Aliases
+    /// @{
+    using value_type = T;
+    using allocator_type = Alloc;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    class reference;
+    using const_reference = optional<const T&>;
+    /// @}
+
+    explicit optional_array(const allocator_type& alloc = allocator_type{} UMLAUT_CALL_SITE_PARAM)
+	: m_values(alloc UMLAUT_CALL_SITE_ARG), m_words(word_allocator(alloc) UMLAUT_CALL_SITE_ARG) {}
+
+    /// @brief Constructs an array of `count` disengaged elements.
+    explicit optional_array(size_type count, const allocator_type& alloc = allocator_type{}
+			    UMLAUT_CALL_SITE_PARAM)
+	: optional_array(alloc UMLAUT_CALL_SITE_ARG) {
+	resize(count);
+    }
+
+    optional_array(const optional_array&) = default;
+
+    optional_array(optional_array&& other) noexcept
+	: m_values(std::move(other.m_values)),
+	  m_words(std::move(other.m_words)),
+	  m_size(std::exchange(other.m_size, 0)) {}
+
+    optional_array& operator=(const optional_array&) = default;
+
+    optional_array& operator=(optional_array&& other) noexcept {
+	m_values = std::move(other.m_values);
+	m_words = std::move(other.m_words);
+	m_size = std::exchange(other.m_size, 0);
+	return *this;
+    }
+
+    /// @brief Returns the allocator associated with the array.
+    allocator_type get_allocator() const noexcept { return m_values.get_allocator(); }
+
+    /// @name Element access
+    /// @{
+
+    /// @brief Returns a proxy to the element at index `i`.
+    reference operator[](size_type i) noexcept {
+	return reference(m_values.data() + i, m_words.data() + i / word_bits, word_type{1} << i % word_bits);
+    }
+
+    /// @brief Returns the element at index `i` as a ul::optional<const T&>.
+    const_reference operator[](size_type i) const noexcept {
+	return has_value(i) ? const_reference(m_values[i]) : const_reference(nullopt);
+    }
+
+    /// @brief Returns a proxy to the element at index `i`.
+    /// @throws std::out_of_range if `i >= size()`.
+    reference at(size_type i) {
+	if (UMLAUT_UNLIKELY(i >= m_size)) {
+	    throw std::out_of_range("optional_array::at");
+	}
+
+	return (*this)[i];
+    }
+
+    /// @brief Const overload of optional_array::at().
+    const_reference at(size_type i) const {
+	if (UMLAUT_UNLIKELY(i >= m_size)) {
+	    throw std::out_of_range("optional_array::at");
+	}
+
+	return (*this)[i];
+    }
+
+    /// @brief Returns whether the element at index `i` is engaged.
+    bool has_value(size_type i) const noexcept {
+	return (m_words[i / word_bits] >> (i % word_bits)) & 1;
+    }
+
+    /// @brief Returns a pointer to the values, including the ones of disengaged elements.
+    const T* values() const noexcept { return m_values.data(); }
+
+    /// @brief Returns a pointer to the validity bitmap, bit `i % 64` of word `i / 64` is
+    /// set if element `i` is engaged.
+    const word_type* validity() const noexcept { return m_words.data(); }
+    /// @}
+
+    /// @name Capacity
+    /// @{
+    size_type size() const noexcept { return m_size; }
+    bool empty() const noexcept { return m_size == 0; }
+
+    /// @brief Reserves storage for at least `new_cap` elements.
+    void reserve(size_type new_cap) {
+	m_words.reserve(word_count(new_cap));
+	m_values.reserve(word_count(new_cap) * word_bits);
+    }
+    /// @}
+
+    /// @name Modifiers
+    /// @{
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+    void push_back(nullopt_t) { resize(m_size + 1); }
+
+    void push_back(const optional<T>& value) {
+	if (value.has_value()) {
+	    emplace_back(*value);
+	}
+	else {
+	    push_back(nullopt);
+	}
+    }
+
+    /// @brief Appends an engaged element constructed from `args`.
+    template <typename ...Args>
+    T& emplace_back(Args&&... args) {
+	// constructed first since `args` may refer to an element of the array
+	T value(std::forward<Args>(args)...);
+
+	if (m_size == m_values.size()) {
+	    add_word();
+	}
+
+	T& slot = m_values[m_size];
+	slot = std::move(value);
+	m_words[m_size / word_bits] |= word_type{1} << m_size % word_bits;
+	++m_size;
+
+	return slot;
+    }
+
+    void pop_back() {
+	UMLAUT_ASSERT(m_size > 0, "pop_back on an empty optional_array");
+	--m_size;
+	m_words[m_size / word_bits] &= ~(word_type{1} << m_size % word_bits);
+
+	if constexpr (!std::is_trivially_destructible_v<T>) {
+	    m_values[m_size] = T();
+	}
+    }
+
+    /// @brief Resizes the array to `count` elements, new elements are disengaged.
+    void resize(size_type count) {
+	if (count < m_size) {
+	    m_values.resize(word_count(count) * word_bits);
+	    m_words.resize(word_count(count));
+
+	    if (count % word_bits != 0) {
+		m_words[count / word_bits] &= (word_type{1} << count % word_bits) - 1;
+	    }
+	}
+	else if (word_count(count) > m_words.size()) {
+	    m_values.resize(word_count(count) * word_bits);
+	    m_words.resize(word_count(count));
+	}
+
+	m_size = count;
+    }
+
+    void clear() noexcept {
+	m_values.clear();
+	m_words.clear();
+	m_size = 0;
+    }
+    /// @}
+
+    /// @name Bulk operations
+    /// @{
+
+    /// @brief Returns the number of engaged elements.
+    size_type engaged_count() const noexcept {
+	return detail::popcount(m_words.data(), word_count(m_size));
+    }
+
+    /// @brief Writes `size()` values to `out`, `default_value` in place of the
+    /// disengaged elements.
+    /// @return Pointer past the last written value.
+    T* value_or(const T& default_value, T* out) const {
+	detail::masked_value_or(m_values.data(), m_words.data(), m_size, default_value, out);
+	return out + m_size;
+    }
+
+    /// @brief Returns the sum of the engaged elements, computed in `Acc`.
+    template <typename Acc = T>
+    Acc sum() const noexcept {
+	static_assert(std::is_arithmetic_v<T>, "sum requires an arithmetic value type");
+	return detail::masked_sum<Acc>(m_values.data(), m_words.data(), word_count(m_size));
+    }
+
+    /// @brief Returns the smallest engaged element, or an empty optional if there are none.
+    ///
+    /// NaN values are ignored, an array of only NaN values has no minimum.
+    optional<T> min() const noexcept {
+	static_assert(std::is_arithmetic_v<T>, "min requires an arithmetic value type");
+
+	if (!any_engaged()) {
+	    return nullopt;
+	}
+
+	constexpr T identity = std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity()
+								    : std::numeric_limits<T>::max();
+	const T result = detail::masked_extremum<true>(m_values.data(), m_words.data(),
+							 word_count(m_size), identity);
+
+	// the identity is also returned when every engaged value is NaN
+	if (result == identity && !any_engaged_number()) {
+	    return nullopt;
+	}
+
+	return result;
+    }
+
+    /// @brief Returns the largest engaged element, or an empty optional if there are none.
+    ///
+    /// NaN values are ignored, an array of only NaN values has no maximum.
+    optional<T> max() const noexcept {
+	static_assert(std::is_arithmetic_v<T>, "max requires an arithmetic value type");
+
+	if (!any_engaged()) {
+	    return nullopt;
+	}
+
+	constexpr T identity = std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity()
+								    : std::numeric_limits<T>::lowest();
+	const T result = detail::masked_extremum<false>(m_values.data(), m_words.data(),
+							  word_count(m_size), identity);
+
+	// the identity is also returned when every engaged value is NaN
+	if (result == identity && !any_engaged_number()) {
+	    return nullopt;
+	}
+
+	return result;
+    }
+
+    /// @}
+
+ private:
+    // the values are padded to whole words of the bitmap, bits past `m_size` are zero
+    small_vector_base<T, Alloc> m_values;
+    small_vector_base<word_type, word_allocator> m_words;
+    size_type m_size = 0;
+
+    static constexpr size_type word_count(size_type count) noexcept {
+	return (count + word_bits - 1) / word_bits;
+    }
+
+    void add_word() {
+	m_values.resize(m_values.size() + word_bits);
+	m_words.push_back(0);
+    }
+
+    bool any_engaged() const noexcept {
+	return std::any_of(m_words.begin(), m_words.begin() + word_count(m_size),
+			   [](word_type word) { return word != 0; });
+    }
+
+    bool any_engaged_number() const noexcept {
+	if constexpr (std::numeric_limits<T>::has_quiet_NaN) {
+	    for (size_type i = 0; i < m_size; ++i) {
+		if (has_value(i) && m_values[i] == m_values[i]) {
+		    return true;
+		}
+	    }
+
+	    return false;
+	}
+	else {
+	    return any_engaged();
+	}
+    }
+};
+
+/// @brief Proxy to an element of a ul::optional_array, behaving like a ul::optional<T&>.
+///
+/// Assigning a value engages the element, assigning `ul::nullopt` disengages it. The
+/// proxy is invalidated by any operation adding or removing elements.
+template <typename T, typename Alloc>
+class optional_array<T, Alloc>::reference {
+    friend class optional_array;
+
+    reference(T* value, word_type* word, word_type mask) noexcept
+	: m_value(value), m_word(word), m_mask(mask) {}
+
+ public:
+    reference(const reference&) = default;
+
+    /// @brief Assigns the element referred to by `other`, not the proxy itself.
+    reference& operator=(const reference& other) {
+	if (other.has_value()) {
+	    *this = *other;
+	}
+	else {
+	    reset();
+	}
+
+	return *this;
+    }
+
+    reference& operator=(const T& value) {
+	*m_value = value;
+	*m_word |= m_mask;
+	return *this;
+    }
+
+    reference& operator=(T&& value) {
+	*m_value = std::move(value);
+	*m_word |= m_mask;
+	return *this;
+    }
+
+    reference& operator=(nullopt_t) noexcept {
+	reset();
+	return *this;
+    }
+
+    bool has_value() const noexcept { return (*m_word & m_mask) != 0; }
+    explicit operator bool() const noexcept { return has_value(); }
+
+    T& operator*() const noexcept { return *m_value; }
+    T* operator->() const noexcept { return m_value; }
+
+    T& value() const {
+	if (!has_value()) {
+	    throw bad_optional_access{};
+	}
+
+	return *m_value;
+    }
+
+    template <typename U>
+    T value_or(U&& default_value) const {
+	return has_value() ? *m_value : static_cast<T>(std::forward<U>(default_value));
+    }
+
+    /// @brief Disengages the element, the value itself is kept.
+    void reset() noexcept { *m_word &= ~m_mask; }
+
+    operator optional<T&>() const noexcept {
+	return has_value() ? optional<T&>(*m_value) : optional<T&>(nullopt);
+    }
+
+    operator optional<const T&>() const noexcept {
+	return has_value() ? optional<const T&>(*m_value) : optional<const T&>(nullopt);
+    }
+
+ private:
+    T* m_value;
+    word_type* m_word;
+    word_type m_mask;
+};
+
+} // namespace ul
@@ -0,0 +1,518 @@
+/// @file
+/// Defines ul::small_ring_buffer.
+///
+/// @copyright Marcus Larsson 2018
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "compressed_pair.hpp"
+#include "config.hpp"
+#include "small_vector.hpp"
+#include "traits.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace ul {
+namespace detail {
+
+/// Random access iterator of ul::small_ring_buffer, storing the buffer and a logical index.
+template <typename Ring, typename T>
+class ring_iterator {
+    template <typename, typename>
+    friend class ring_iterator;
+
+ public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::remove_const_t<T>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T*;
+    using reference = T&;
+
+    ring_iterator() noexcept = default;
+
+    ring_iterator(Ring* ring, std::size_t index) noexcept : m_ring(ring), m_index(index) {}
+
+    /// @brief Conversion from iterator to const_iterator.
+    template <typename U, typename = std::enable_if_t<std::is_same_v<const U, T>>>
+    ring_iterator(const ring_iterator<std::remove_const_t<Ring>, U>& other) noexcept
+	: m_ring(other.m_ring), m_index(other.m_index) {}
+
+    reference operator*() const noexcept { return (*m_ring)[m_index]; }
+    pointer operator->() const noexcept { return std::addressof(**this); }
+    reference operator[](difference_type n) const noexcept { return (*m_ring)[m_index + n]; }
+
+    ring_iterator& operator++() noexcept { ++m_index; return *this; }
+    ring_iterator& operator--() noexcept { --m_index; return *this; }
+    ring_iterator operator++(int) noexcept { auto copy = *this; ++m_index; return copy; }
+    ring_iterator operator--(int) noexcept { auto copy = *this; --m_index; return copy; }
+
+    ring_iterator& operator+=(difference_type n) noexcept { m_index += n; return *this; }
+    ring_iterator& operator-=(difference_type n) noexcept { m_index -= n; return *this; }
+
+    friend ring_iterator operator+(ring_iterator it, difference_type n) noexcept { return it += n; }
+    friend ring_iterator operator+(difference_type n, ring_iterator it) noexcept { return it += n; }
+    friend ring_iterator operator-(ring_iterator it, difference_type n) noexcept { return it -= n; }
+
+    friend difference_type operator-(const ring_iterator& lhs, const ring_iterator& rhs) noexcept {
+	return static_cast<difference_type>(lhs.m_index - rhs.m_index);
+    }
+
+    friend bool operator==(const ring_iterator& lhs, const ring_iterator& rhs) noexcept {
+	return lhs.m_index == rhs.m_index;
+    }
+
+    friend bool operator!=(const ring_iterator& lhs, const ring_iterator& rhs) noexcept {
+	return lhs.m_index != rhs.m_index;
+    }
+
+    friend bool operator<(const ring_iterator& lhs, const ring_iterator& rhs) noexcept {
+	return lhs.m_index < rhs.m_index;
+    }
+
+    friend bool operator>(const ring_iterator& lhs, const ring_iterator& rhs) noexcept {
+	return lhs.m_index > rhs.m_index;
+    }
+
+    friend bool operator<=(const ring_iterator& lhs, const ring_iterator& rhs) noexcept {
+	return lhs.m_index <= rhs.m_index;
+    }
+
+    friend bool operator>=(const ring_iterator& lhs, const ring_iterator& rhs) noexcept {
+	return lhs.m_index >= rhs.m_index;
+    }
+
+ private:
+    Ring* m_ring = nullptr;
+    std::size_t m_index = 0;
+};
+
+} // namespace detail
+
+/// @brief Double-ended queue storing up to `N` elements inline before spilling to the heap.
+///
+/// The elements are kept in a single circular buffer, so ul::small_ring_buffer::push_front(),
+/// ul::small_ring_buffer::pop_front() and their counterparts at the back are O(1)
+/// without the chunked allocations of `std::deque`. A queue which never holds more than
+/// `N` elements at once never allocates, no matter how many elements pass through it.
+///
+/// Like ul::small_vector the capacity grows by the growth factor defined in config.hpp.
+/// On growth the two halves of the circle are relocated to the start of the new buffer,
+/// with `memcpy` for trivially relocatable types.
+template <typename T, std::size_t N, typename Alloc = std::allocator<T>>
+class small_ring_buffer : private detail::small_vector_storage<T, N> {
+    using storage = detail::small_vector_storage<T, N>;
+    using alloc_traits = std::allocator_traits<Alloc>;
+
+ public:
+    /// @name Aliases
+    /// @{
+    using value_type = T;
+    using allocator_type = Alloc;
+    using size_type = typename alloc_traits::size_type;
+    using difference_type = typename alloc_traits::difference_type;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using pointer = typename alloc_traits::pointer;
+    using const_pointer = typename alloc_traits::const_pointer;
+    using iterator = detail::ring_iterator<small_ring_buffer, value_type>;
+    using const_iterator = detail::ring_iterator<const small_ring_buffer, const value_type>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+    /// @}
+
+    /// @brief Number of elements which fit in the inline buffer.
+    static constexpr size_type inline_capacity = N;
+
+    explicit small_ring_buffer(const allocator_type& alloc = allocator_type{})
+	: m_data_and_alloc(inline_data(), alloc) {}
+
+    /// @brief Constructs the buffer from a list of values, see ul::list_construct_t.
+    template <typename ...Ts, typename = std::enable_if_t<
+	!std::is_same_v<remove_cvref_t<pack_element_t<0, Ts...>>, allocator_type>
+    >>
+    small_ring_buffer(list_construct_t, Ts&&... values)
+	: small_ring_buffer(list_construct, allocator_type{}, std::forward<Ts>(values)...) {}
+
+    template <typename ...Ts>
+    small_ring_buffer(list_construct_t, const allocator_type& alloc, Ts&&... values)
+	: small_ring_buffer(alloc) {
+	reserve(sizeof...(values));
+	(emplace_back(std::forward<Ts>(values)), ...);
+    }
+
+    small_ring_buffer(const small_ring_buffer& other)
+	: small_ring_buffer(alloc_traits::select_on_container_copy_construction(other.m_alloc())) {
+	copy_from(other);
+    }
+
+    /// @brief Move constructor.
+    ///
+    /// Steals the heap allocation of `other` if it has one, otherwise the inline
+    /// elements are relocated. `other` is left empty.
+    small_ring_buffer(small_ring_buffer&& other) noexcept(
+	is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible_v<T>)
+	: small_ring_buffer(other.m_alloc()) {
+	move_from(other);
+    }
+
+    ~small_ring_buffer() {
+	destroy_all();
+	deallocate_heap();
+    }
+
+    small_ring_buffer& operator=(const small_ring_buffer& other) {
+	if (this != &other) {
+	    clear();
+	    copy_from(other);
+	}
+
+	return *this;
+    }
+
+    small_ring_buffer& operator=(small_ring_buffer&& other) noexcept(
+	(is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible_v<T>) &&
+	(alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value)) {
+	if (this != &other) {
+	    clear();
+	    move_from(other);
+	}
+
+	return *this;
+    }
+
+    /// @brief Returns the allocator associated with the buffer.
+    allocator_type get_allocator() const noexcept { return m_alloc(); }
+
+    /// @name Element access
+    /// @{
+
+    /// @brief Returns the element at index `i` counted from the front.
+    reference operator[](size_type i) noexcept { return m_data()[slot(i)]; }
+
+    /// @brief Const overload of `small_ring_buffer::operator[]`.
+    const_reference operator[](size_type i) const noexcept { return m_data()[slot(i)]; }
+
+    /// @brief Returns the element at index `i` counted from the front.
+    /// @throws std::out_of_range if `i >= size()`.
+    reference at(size_type i) {
+	if (UMLAUT_UNLIKELY(i >= m_size)) {
+	    throw std::out_of_range("small_ring_buffer::at");
+	}
+
+	return (*this)[i];
+    }
+
+    /// @brief Const overload of small_ring_buffer::at().
+    const_reference at(size_type i) const {
+	if (UMLAUT_UNLIKELY(i >= m_size)) {
+	    throw std::out_of_range("small_ring_buffer::at");
+	}
+
+	return (*this)[i];
+    }
+
+    reference front() noexcept { return m_data()[m_head]; }
+    const_reference front() const noexcept { return m_data()[m_head]; }
+    reference back() noexcept { return (*this)[m_size - 1]; }
+    const_reference back() const noexcept { return (*this)[m_size - 1]; }
+    /// @}
+
+    /// @name Iterators
+    /// @{
+    iterator begin() noexcept { return iterator(this, 0); }
+    const_iterator cbegin() const noexcept { return const_iterator(this, 0); }
+    const_iterator begin() const noexcept { return const_iterator(this, 0); }
+    iterator end() noexcept { return iterator(this, m_size); }
+    const_iterator cend() const noexcept { return const_iterator(this, m_size); }
+    const_iterator end() const noexcept { return const_iterator(this, m_size); }
+    reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator crend() const noexcept { return const_reverse_iterator(begin()); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+    /// @}
+
+    /// @name Capacity
+    /// @{
+    size_type size() const noexcept { return m_size; }
+    size_type capacity() const noexcept { return m_capacity; }
+    bool empty() const noexcept { return m_size == 0; }
+
+    size_type max_size() const noexcept { return alloc_traits::max_size(m_alloc()); }
+
+    /// @brief Increases the capacity of the buffer to be greater or equal to `new_cap`.
+    /// @throws std::length_error if `new_cap > max_size()`.
+    void reserve(size_type new_cap) {
+	if (UMLAUT_UNLIKELY(new_cap > max_size())) {
+	    throw std::length_error("small_ring_buffer::reserve");
+	}
+	else if (new_cap > m_capacity) {
+	    pointer new_data = alloc_traits::allocate(m_alloc(), new_cap);
+
+	    try {
+		relocate_to(new_data);
+	    }
+	    catch (...) {
+		alloc_traits::deallocate(m_alloc(), new_data, new_cap);
+		throw;
+	    }
+
+	    replace_storage(new_data, new_cap);
+	}
+    }
+
+    /// @brief Returns whether the elements are stored in the inline buffer or not.
+    bool is_inline() const noexcept { return m_data() == inline_data(); }
+    /// @}
+
+    /// @name Modifiers
+    /// @{
+    void push_back(const value_type& value) { emplace_back(value); }
+    void push_back(value_type&& value) { emplace_back(std::move(value)); }
+
+    /// @brief Constructs an element at the back.
+    template <typename ...Args>
+    reference emplace_back(Args&&... args) {
+	if (UMLAUT_UNLIKELY(m_size == m_capacity)) {
+	    return grow_and_emplace(m_size, std::forward<Args>(args)...);
+	}
+
+	pointer ptr = m_data() + slot(m_size);
+	alloc_traits::construct(m_alloc(), ptr, std::forward<Args>(args)...);
+	++m_size;
+	return *ptr;
+    }
+
+    void push_front(const value_type& value) { emplace_front(value); }
+    void push_front(value_type&& value) { emplace_front(std::move(value)); }
+
+    /// @brief Constructs an element at the front.
+    template <typename ...Args>
+    reference emplace_front(Args&&... args) {
+	if (UMLAUT_UNLIKELY(m_size == m_capacity)) {
+	    return grow_and_emplace(0, std::forward<Args>(args)...);
+	}
+
+	const size_type head = m_head == 0 ? m_capacity - 1 : m_head - 1;
+	alloc_traits::construct(m_alloc(), m_data() + head, std::forward<Args>(args)...);
+	m_head = head;
+	++m_size;
+	return m_data()[head];
+    }
+
+    void pop_back() noexcept {
+	UMLAUT_ASSERT(m_size > 0, "pop_back on an empty small_ring_buffer");
+	--m_size;
+	alloc_traits::destroy(m_alloc(), m_data() + slot(m_size));
+    }
+
+    void pop_front() noexcept {
+	UMLAUT_ASSERT(m_size > 0, "pop_front on an empty small_ring_buffer");
+	alloc_traits::destroy(m_alloc(), m_data() + m_head);
+	m_head = slot(1);
+	--m_size;
+    }
+
+    void clear() noexcept {
+	destroy_all();
+	m_head = 0;
+	m_size = 0;
+    }
+    /// @}
+
+ private:
+    compressed_pair<pointer, allocator_type> m_data_and_alloc;
+    size_type m_head = 0;
+    size_type m_size = 0;
+    size_type m_capacity = N;
+
+    pointer& m_data() noexcept { return m_data_and_alloc.first(); }
+    const pointer& m_data() const noexcept { return m_data_and_alloc.first(); }
+
+    allocator_type& m_alloc() noexcept { return m_data_and_alloc.second(); }
+    const allocator_type& m_alloc() const noexcept { return m_data_and_alloc.second(); }
+
+    pointer inline_data() const noexcept {
+	if constexpr (N == 0) {
+	    return nullptr;
+	}
+	else {
+	    auto buffer = const_cast<unsigned char*>(static_cast<const storage*>(this)->m_buffer);
+	    return reinterpret_cast<pointer>(buffer);
+	}
+    }
+
+    /// @brief Returns the position in the buffer of the element at index `i`.
+    ///
+    /// Wraps with a conditional subtraction rather than a modulo, so any capacity can be
+    /// used without the cost of a division.
+    size_type slot(size_type i) const noexcept {
+	const size_type pos = m_head + i;
+	return pos >= m_capacity ? pos - m_capacity : pos;
+    }
+
+    /// @brief Returns the capacity to grow to when at least `min_cap` elements are needed,
+    /// see small_vector_base::recommended_capacity().
+    size_type recommended_capacity(size_type min_cap) const {
+	constexpr size_type num = UMLAUT_GROWTH_FACTOR_NUM;
+	constexpr size_type den = UMLAUT_GROWTH_FACTOR_DEN;
+
+	const size_type max = max_size();
+
+	if (UMLAUT_UNLIKELY(min_cap > max)) {
+	    throw std::length_error("small_ring_buffer");
+	}
+
+	if (m_capacity > max / num) {
+	    return max;
+	}
+
+	const size_type grown = m_capacity * num / den;
+	return grown > min_cap ? grown : min_cap;
+    }
+
+    /// @brief Relocates the elements in order to the start of the uninitialized memory at `dest`.
+    ///
+    /// The elements form at most two contiguous runs, which are copied with one `memcpy`
+    /// each for trivially relocatable types. Other types are moved if their move
+    /// constructor is `noexcept` and copied otherwise, and the old elements are only
+    /// destroyed once all of them have been constructed at their new location.
+    void relocate_to(pointer dest) {
+	const size_type first_run = m_size < m_capacity - m_head ? m_size : m_capacity - m_head;
+
+	if constexpr (is_trivially_relocatable_v<value_type>) {
+	    if (m_size > 0) {
+		std::memcpy(static_cast<void*>(dest), static_cast<const void*>(m_data() + m_head),
+			    first_run * sizeof(value_type));
+		std::memcpy(static_cast<void*>(dest + first_run), static_cast<const void*>(m_data()),
+			    (m_size - first_run) * sizeof(value_type));
+	    }
+	}
+	else {
+	    size_type i = 0;
+
+	    try {
+		for (; i < m_size; ++i) {
+		    alloc_traits::construct(m_alloc(), dest + i, std::move_if_noexcept((*this)[i]));
+		}
+	    }
+	    catch (...) {
+		for (size_type j = 0; j < i; ++j) {
+		    alloc_traits::destroy(m_alloc(), dest + j);
+		}
+
+		throw;
+	    }
+
+	    destroy_all();
+	}
+    }
+
+    /// @brief Slow path of small_ring_buffer::emplace_back() and
+    /// small_ring_buffer::emplace_front() when the buffer is full.
+    ///
+    /// The new element is constructed before the old elements are relocated since `args`
+    /// may refer to an element of the buffer itself.
+    template <typename ...Args>
+    reference grow_and_emplace(size_type index, Args&&... args) {
+	const size_type new_cap = recommended_capacity(m_size + 1);
+	pointer new_data = alloc_traits::allocate(m_alloc(), new_cap);
+	pointer ptr = new_data + index;
+
+	try {
+	    alloc_traits::construct(m_alloc(), ptr, std::forward<Args>(args)...);
+
+	    try {
+		relocate_to(new_data + (index == 0 ? 1 : 0));
+	    }
+	    catch (...) {
+		alloc_traits::destroy(m_alloc(), ptr);
+		throw;
+	    }
+	}
+	catch (...) {
+	    alloc_traits::deallocate(m_alloc(), new_data, new_cap);
+	    throw;
+	}
+
+	replace_storage(new_data, new_cap);
+	++m_size;
+	return *ptr;
+    }
+
+    /// @brief Releases the current storage, whose elements have already been relocated
+    /// to the start of `new_data`, and takes ownership of `new_data`.
+    void replace_storage(pointer new_data, size_type new_cap) noexcept {
+	deallocate_heap();
+
+	m_data() = new_data;
+	m_head = 0;
+	m_capacity = new_cap;
+    }
+
+    void copy_from(const small_ring_buffer& other) {
+	reserve(other.m_size);
+
+	for (const auto& value : other) {
+	    emplace_back(value);
+	}
+    }
+
+    /// @brief Moves the elements of `other` into an empty buffer.
+    ///
+    /// The heap allocation of `other` is stolen when possible, `other` is then reset to
+    /// its inline buffer.
+    void move_from(small_ring_buffer& other) {
+	const bool can_steal = alloc_traits::propagate_on_container_move_assignment::value ||
+			       alloc_traits::is_always_equal::value || m_alloc() == other.m_alloc();
+
+	if (!other.is_inline() && can_steal) {
+	    deallocate_heap();
+
+	    if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+		m_alloc() = std::move(other.m_alloc());
+	    }
+
+	    m_data() = other.m_data();
+	    m_head = other.m_head;
+	    m_size = other.m_size;
+	    m_capacity = other.m_capacity;
+
+	    other.m_data() = other.inline_data();
+	    other.m_capacity = N;
+	}
+	else {
+	    reserve(other.m_size);
+	    other.relocate_to(m_data());
+	    m_size = other.m_size;
+	}
+
+	other.m_head = 0;
+	other.m_size = 0;
+    }
+
+    void destroy_all() noexcept {
+	if constexpr (!std::is_trivially_destructible_v<value_type>) {
+	    for (size_type i = 0; i < m_size; ++i) {
+		alloc_traits::destroy(m_alloc(), m_data() + slot(i));
+	    }
+	}
+    }
+
+    void deallocate_heap() noexcept {
+	if (!is_inline()) {
+	    alloc_traits::deallocate(m_alloc(), m_data(), m_capacity);
+	}
+    }
+};
+
+} // namespace ul
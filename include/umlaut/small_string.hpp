@@ -0,0 +1,546 @@
+/// @file
+/// Defines ul::basic_small_string and ul::small_string.
+///
+/// @copyright Marcus Larsson 2018
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "small_vector.hpp"
+#include "traits.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iosfwd>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace ul {
+
+/// @brief String storing up to `N` characters inline before spilling to the heap.
+///
+/// Unlike `std::basic_string`, whose inline capacity is fixed by the standard library
+/// (15 characters for `char` in libstdc++ and 22 in libc++), the inline capacity is
+/// chosen by the user. The characters are stored in a ul::small_vector together with
+/// the null terminator, so growth, the realloc path of reallocating allocators and the
+/// allocation statistics are shared with it.
+///
+/// The string converts implicitly to `std::basic_string_view`, which is how searching,
+/// substrings and other read-only operations are meant to be done. Appending a
+/// contiguous range grows the string at most once and copies the characters with
+/// `Traits::copy`.
+template <std::size_t N, typename Char, typename Traits = std::char_traits<Char>,
+	  typename Alloc = std::allocator<Char>>
+class basic_small_string {
+    using container_type = small_vector<Char, N + 1, Alloc>;
+    using view_type = std::basic_string_view<Char, Traits>;
+
+    template <typename T>
+    using enable_if_view_t = std::enable_if_t<
+	std::is_convertible_v<const T&, view_type> && !std::is_convertible_v<const T&, const Char*>
+    >;
+
+ public:
+    using traits_type = Traits;
+    using value_type = Char;
+    using allocator_type = Alloc;
+    using size_type = typename container_type::size_type;
+    using difference_type = typename container_type::difference_type;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using pointer = typename container_type::pointer;
+    using const_pointer = typename container_type::const_pointer;
+    using iterator = value_type*;
+    using const_iterator = const value_type*;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    /// @brief Special value used as "until the end" by basic_small_string::erase().
+    static constexpr size_type npos = static_cast<size_type>(-1);
+
+    /// @brief Number of characters which fit in the inline buffer, not counting the
+    /// null terminator.
+    static constexpr size_type inline_capacity = N;
+
+    explicit basic_small_string(const allocator_type& alloc = allocator_type{} UMLAUT_CALL_SITE_PARAM)
+	: m_chars(alloc UMLAUT_CALL_SITE_ARG) {
+	m_chars.push_back_unchecked(Char());
+    }
+
+    basic_small_string(const Char* str, const allocator_type& alloc = allocator_type{}
+		       UMLAUT_CALL_SITE_PARAM)
+	: basic_small_string(alloc UMLAUT_CALL_SITE_ARG) {
+	append(str);
+    }
+
+    basic_small_string(const Char* str, size_type count, const allocator_type& alloc = allocator_type{}
+		       UMLAUT_CALL_SITE_PARAM)
+	: basic_small_string(alloc UMLAUT_CALL_SITE_ARG) {
+	append(str, count);
+    }
+
+    basic_small_string(size_type count, Char ch, const allocator_type& alloc = allocator_type{}
+		       UMLAUT_CALL_SITE_PARAM)
+	: basic_small_string(alloc UMLAUT_CALL_SITE_ARG) {
+	append(count, ch);
+    }
+
+    template <typename InputIt, typename = detail::enable_if_iterator_t<InputIt>>
+    basic_small_string(InputIt first, InputIt last, const allocator_type& alloc = allocator_type{}
+		       UMLAUT_CALL_SITE_PARAM)
+	: basic_small_string(alloc UMLAUT_CALL_SITE_ARG) {
+	append(first, last);
+    }
+
+    /// @brief Constructs the string from anything convertible to `std::basic_string_view`,
+    /// such as `std::basic_string` or a `basic_small_string` of another inline capacity.
+    template <typename T, typename = enable_if_view_t<T>>
+    explicit basic_small_string(const T& value, const allocator_type& alloc = allocator_type{}
+				UMLAUT_CALL_SITE_PARAM)
+	: basic_small_string(alloc UMLAUT_CALL_SITE_ARG) {
+	append(value);
+    }
+
+    basic_small_string(const basic_small_string&) = default;
+
+    /// @brief Move constructor, see ul::small_vector::small_vector(small_vector&&).
+    ///
+    /// `other` is left empty.
+    basic_small_string(basic_small_string&& other) noexcept
+	: m_chars(std::move(other.m_chars)) {
+	other.m_chars.push_back_unchecked(Char());
+    }
+
+    basic_small_string& operator=(const basic_small_string&) = default;
+
+    basic_small_string& operator=(basic_small_string&& other) noexcept(
+	std::is_nothrow_move_assignable_v<container_type>) {
+	m_chars = std::move(other.m_chars);
+
+	if (other.m_chars.empty()) {
+	    other.m_chars.push_back_unchecked(Char());
+	}
+
+	return *this;
+    }
+
+    basic_small_string& operator=(const Char* str) { return assign(str); }
+
+    template <typename T, typename = enable_if_view_t<T>>
+    basic_small_string& operator=(const T& value) { return assign(value); }
+
+    basic_small_string& assign(const Char* str) { return assign(str, traits_type::length(str)); }
+
+    basic_small_string& assign(const Char* str, size_type count) {
+	if (str >= data() && str <= data() + size()) {
+	    traits_type::move(data(), str, count);
+	    resize(count);
+	    return *this;
+	}
+
+	clear();
+	return append(str, count);
+    }
+
+    basic_small_string& assign(size_type count, Char ch) {
+	clear();
+	return append(count, ch);
+    }
+
+    template <typename InputIt, typename = detail::enable_if_iterator_t<InputIt>>
+    basic_small_string& assign(InputIt first, InputIt last) {
+	if constexpr (detail::is_memcpy_compatible_v<InputIt, Char>) {
+	    return assign(first, static_cast<size_type>(last - first));
+	}
+	else {
+	    clear();
+	    return append(first, last);
+	}
+    }
+
+    template <typename T, typename = enable_if_view_t<T>>
+    basic_small_string& assign(const T& value) {
+	const view_type view = value;
+	return assign(view.data(), static_cast<size_type>(view.size()));
+    }
+
+    /// @brief Returns the allocator associated with the string.
+    allocator_type get_allocator() const noexcept { return m_chars.get_allocator(); }
+
+    /// @name Element access
+    /// @{
+
+    /// @brief Returns the character at index `i`.
+    Char& operator[](size_type i) { return m_chars[i]; }
+
+    /// @brief Const overload of `basic_small_string::operator[]`.
+    const Char& operator[](size_type i) const { return m_chars[i]; }
+
+    /// @brief Returns the character at index `i`.
+    /// @throws std::out_of_range if `i >= size()`.
+    Char& at(size_type i) {
+	if (UMLAUT_UNLIKELY(i >= size())) {
+	    throw std::out_of_range("basic_small_string::at");
+	}
+
+	return m_chars[i];
+    }
+
+    /// @brief Const overload of basic_small_string::at().
+    const Char& at(size_type i) const {
+	if (UMLAUT_UNLIKELY(i >= size())) {
+	    throw std::out_of_range("basic_small_string::at");
+	}
+
+	return m_chars[i];
+    }
+
+    Char& front() { return m_chars[0]; }
+    const Char& front() const { return m_chars[0]; }
+    Char& back() { return m_chars[size() - 1]; }
+    const Char& back() const { return m_chars[size() - 1]; }
+
+    /// @brief Returns a pointer to the null terminated characters of the string.
+    Char* data() noexcept { return m_chars.data(); }
+
+    /// @brief Const overload of basic_small_string::data().
+    const Char* data() const noexcept { return m_chars.data(); }
+
+    /// @brief Returns a pointer to the null terminated characters of the string.
+    const Char* c_str() const noexcept { return m_chars.data(); }
+
+    /// @brief Returns a view of the characters, which neither copies nor allocates.
+    operator view_type() const noexcept { return view_type(data(), size()); }
+    /// @}
+
+    /// @name Iterators
+    /// @{
+    iterator begin() noexcept { return data(); }
+    const_iterator cbegin() const noexcept { return data(); }
+    const_iterator begin() const noexcept { return data(); }
+    iterator end() noexcept { return data() + size(); }
+    const_iterator cend() const noexcept { return data() + size(); }
+    const_iterator end() const noexcept { return data() + size(); }
+    reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator crend() const noexcept { return const_reverse_iterator(begin()); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+    /// @}
+
+    /// @name Capacity
+    /// @{
+
+    /// @brief Returns the number of characters, not counting the null terminator.
+    size_type size() const noexcept { return m_chars.size() - 1; }
+
+    /// @brief Same as basic_small_string::size().
+    size_type length() const noexcept { return m_chars.size() - 1; }
+
+    bool empty() const noexcept { return m_chars.size() == 1; }
+
+    /// @brief Returns the number of characters the string can hold before it has to
+    /// reallocate, not counting the null terminator.
+    size_type capacity() const noexcept { return m_chars.capacity() - 1; }
+
+    size_type max_size() const noexcept { return m_chars.max_size() - 1; }
+
+    /// @brief Increases the capacity of the string to be greater or equal to `new_cap`.
+    /// @throws std::length_error if `new_cap > max_size()`.
+    void reserve(size_type new_cap) {
+	if (UMLAUT_UNLIKELY(new_cap > max_size())) {
+	    throw std::length_error("basic_small_string::reserve");
+	}
+
+	m_chars.reserve(new_cap + 1);
+    }
+
+    /// @brief Reduces the capacity of the string to its size, see
+    /// ul::small_vector::shrink_to_fit().
+    void shrink_to_fit() { m_chars.shrink_to_fit(); }
+
+    /// @brief Returns whether the characters are stored in the inline buffer or not.
+    bool is_inline() const noexcept { return m_chars.is_inline(); }
+    /// @}
+
+    /// @name Modifiers
+    /// @{
+    void clear() noexcept {
+	m_chars.clear();
+	m_chars.push_back_unchecked(Char());
+    }
+
+    void push_back(Char ch) {
+	// grows first so the string is untouched if growing throws
+	m_chars.push_back(Char());
+	m_chars[size() - 1] = ch;
+    }
+
+    void pop_back() {
+	m_chars.pop_back();
+	m_chars[size()] = Char();
+    }
+
+    /// @brief Appends `count` characters starting at `str`.
+    ///
+    /// The string grows at most once and the characters are copied with `Traits::copy`.
+    /// `str` may point into the string itself.
+    /// @throws std::length_error if the size would exceed `max_size()`.
+    basic_small_string& append(const Char* str, size_type count) {
+	const bool is_self = str >= data() && str <= data() + size();
+	const auto offset = str - data();
+	Char* dest = grow_for_overwrite(count);
+
+	if (is_self) {
+	    str = data() + offset;
+	}
+
+	traits_type::copy(dest, str, count);
+	return *this;
+    }
+
+    basic_small_string& append(const Char* str) { return append(str, traits_type::length(str)); }
+
+    basic_small_string& append(size_type count, Char ch) {
+	traits_type::assign(grow_for_overwrite(count), count, ch);
+	return *this;
+    }
+
+    /// @brief Appends the characters in `[first, last)`.
+    ///
+    /// Contiguous ranges take the same path as appending a pointer and a count, other
+    /// forward ranges are measured first so the string still grows at most once.
+    template <typename InputIt, typename = detail::enable_if_iterator_t<InputIt>>
+    basic_small_string& append(InputIt first, InputIt last) {
+	if constexpr (detail::is_memcpy_compatible_v<InputIt, Char>) {
+	    return append(first, static_cast<size_type>(last - first));
+	}
+	else if constexpr (detail::is_forward_iterator_v<InputIt>) {
+	    const auto count = static_cast<size_type>(std::distance(first, last));
+	    std::copy(first, last, grow_for_overwrite(count));
+	    return *this;
+	}
+	else {
+	    for (; first != last; ++first) {
+		push_back(*first);
+	    }
+
+	    return *this;
+	}
+    }
+
+    template <typename T, typename = enable_if_view_t<T>>
+    basic_small_string& append(const T& value) {
+	const view_type view = value;
+	return append(view.data(), static_cast<size_type>(view.size()));
+    }
+
+    basic_small_string& operator+=(const Char* str) { return append(str); }
+
+    basic_small_string& operator+=(Char ch) {
+	push_back(ch);
+	return *this;
+    }
+
+    template <typename T, typename = enable_if_view_t<T>>
+    basic_small_string& operator+=(const T& value) { return append(value); }
+
+    /// @brief Removes up to `count` characters starting at `index`.
+    /// @throws std::out_of_range if `index > size()`.
+    basic_small_string& erase(size_type index = 0, size_type count = npos) {
+	if (UMLAUT_UNLIKELY(index > size())) {
+	    throw std::out_of_range("basic_small_string::erase");
+	}
+
+	count = std::min(count, static_cast<size_type>(size() - index));
+	m_chars.erase(m_chars.begin() + index, m_chars.begin() + index + count);
+	return *this;
+    }
+
+    iterator erase(const_iterator pos) { return m_chars.erase(pos); }
+
+    iterator erase(const_iterator first, const_iterator last) { return m_chars.erase(first, last); }
+
+    /// @brief Resizes the string to `count` characters, new characters are copies of `ch`.
+    void resize(size_type count, Char ch = Char()) {
+	if (count <= size()) {
+	    m_chars.resize_for_overwrite(count + 1);
+	    m_chars[size()] = Char();
+	}
+	else {
+	    append(count - size(), ch);
+	}
+    }
+
+    void swap(basic_small_string& other) noexcept {
+	m_chars.swap(other.m_chars);
+    }
+
+    friend void swap(basic_small_string& lhs, basic_small_string& rhs) noexcept {
+	lhs.swap(rhs);
+    }
+    /// @}
+
+    /// @brief Compares the characters lexicographically, see `std::basic_string_view::compare()`.
+    int compare(view_type other) const noexcept { return view_type(*this).compare(other); }
+
+ private:
+    container_type m_chars;
+
+    /// @brief Grows the string by `count` uninitialized characters followed by a null
+    /// terminator and returns a pointer to the first of them.
+    Char* grow_for_overwrite(size_type count) {
+	const size_type old_size = size();
+
+	if (UMLAUT_UNLIKELY(count > max_size() - old_size)) {
+	    throw std::length_error("basic_small_string");
+	}
+
+	m_chars.resize_for_overwrite(old_size + count + 1);
+	m_chars[size()] = Char();
+	return data() + old_size;
+    }
+};
+
+/// @brief ul::basic_small_string of `char`.
+template <std::size_t N>
+using small_string = basic_small_string<N, char>;
+
+/// @brief ul::basic_small_string of `wchar_t`.
+template <std::size_t N>
+using small_wstring = basic_small_string<N, wchar_t>;
+
+template <std::size_t N, std::size_t M, typename Char, typename Traits, typename A1, typename A2>
+bool operator==(const basic_small_string<N, Char, Traits, A1>& lhs,
+		const basic_small_string<M, Char, Traits, A2>& rhs) noexcept {
+    return lhs.size() == rhs.size() && lhs.compare(rhs) == 0;
+}
+
+template <std::size_t N, typename Char, typename Traits, typename Alloc>
+bool operator==(const basic_small_string<N, Char, Traits, Alloc>& lhs,
+		type_identity_t<std::basic_string_view<Char, Traits>> rhs) noexcept {
+    return lhs.size() == rhs.size() && lhs.compare(rhs) == 0;
+}
+
+template <std::size_t N, typename Char, typename Traits, typename Alloc>
+bool operator==(type_identity_t<std::basic_string_view<Char, Traits>> lhs,
+		const basic_small_string<N, Char, Traits, Alloc>& rhs) noexcept {
+    return lhs.size() == rhs.size() && rhs.compare(lhs) == 0;
+}
+
+template <std::size_t N, std::size_t M, typename Char, typename Traits, typename A1, typename A2>
+bool operator!=(const basic_small_string<N, Char, Traits, A1>& lhs,
+		const basic_small_string<M, Char, Traits, A2>& rhs) noexcept {
+    return !(lhs == rhs);
+}
+
+template <std::size_t N, typename Char, typename Traits, typename Alloc>
+bool operator!=(const basic_small_string<N, Char, Traits, Alloc>& lhs,
+		type_identity_t<std::basic_string_view<Char, Traits>> rhs) noexcept {
+    return !(lhs == rhs);
+}
+
+template <std::size_t N, typename Char, typename Traits, typename Alloc>
+bool operator!=(type_identity_t<std::basic_string_view<Char, Traits>> lhs,
+		const basic_small_string<N, Char, Traits, Alloc>& rhs) noexcept {
+    return !(lhs == rhs);
+}
+
+template <std::size_t N, std::size_t M, typename Char, typename Traits, typename A1, typename A2>
+bool operator<(const basic_small_string<N, Char, Traits, A1>& lhs,
+	       const basic_small_string<M, Char, Traits, A2>& rhs) noexcept {
+    return lhs.compare(rhs) < 0;
+}
+
+template <std::size_t N, typename Char, typename Traits, typename Alloc>
+bool operator<(const basic_small_string<N, Char, Traits, Alloc>& lhs,
+	       type_identity_t<std::basic_string_view<Char, Traits>> rhs) noexcept {
+    return lhs.compare(rhs) < 0;
+}
+
+template <std::size_t N, typename Char, typename Traits, typename Alloc>
+bool operator<(type_identity_t<std::basic_string_view<Char, Traits>> lhs,
+	       const basic_small_string<N, Char, Traits, Alloc>& rhs) noexcept {
+    return rhs.compare(lhs) > 0;
+}
+
+template <std::size_t N, std::size_t M, typename Char, typename Traits, typename A1, typename A2>
+bool operator<=(const basic_small_string<N, Char, Traits, A1>& lhs,
+		const basic_small_string<M, Char, Traits, A2>& rhs) noexcept {
+    return lhs.compare(rhs) <= 0;
+}
+
+template <std::size_t N, typename Char, typename Traits, typename Alloc>
+bool operator<=(const basic_small_string<N, Char, Traits, Alloc>& lhs,
+		type_identity_t<std::basic_string_view<Char, Traits>> rhs) noexcept {
+    return lhs.compare(rhs) <= 0;
+}
+
+template <std::size_t N, typename Char, typename Traits, typename Alloc>
+bool operator<=(type_identity_t<std::basic_string_view<Char, Traits>> lhs,
+		const basic_small_string<N, Char, Traits, Alloc>& rhs) noexcept {
+    return rhs.compare(lhs) >= 0;
+}
+
+template <std::size_t N, std::size_t M, typename Char, typename Traits, typename A1, typename A2>
+bool operator>(const basic_small_string<N, Char, Traits, A1>& lhs,
+	       const basic_small_string<M, Char, Traits, A2>& rhs) noexcept {
+    return lhs.compare(rhs) > 0;
+}
+
+template <std::size_t N, typename Char, typename Traits, typename Alloc>
+bool operator>(const basic_small_string<N, Char, Traits, Alloc>& lhs,
+	       type_identity_t<std::basic_string_view<Char, Traits>> rhs) noexcept {
+    return lhs.compare(rhs) > 0;
+}
+
+template <std::size_t N, typename Char, typename Traits, typename Alloc>
+bool operator>(type_identity_t<std::basic_string_view<Char, Traits>> lhs,
+	       const basic_small_string<N, Char, Traits, Alloc>& rhs) noexcept {
+    return rhs.compare(lhs) < 0;
+}
+
+template <std::size_t N, std::size_t M, typename Char, typename Traits, typename A1, typename A2>
+bool operator>=(const basic_small_string<N, Char, Traits, A1>& lhs,
+		const basic_small_string<M, Char, Traits, A2>& rhs) noexcept {
+    return lhs.compare(rhs) >= 0;
+}
+
+template <std::size_t N, typename Char, typename Traits, typename Alloc>
+bool operator>=(const basic_small_string<N, Char, Traits, Alloc>& lhs,
+		type_identity_t<std::basic_string_view<Char, Traits>> rhs) noexcept {
+    return lhs.compare(rhs) >= 0;
+}
+
+template <std::size_t N, typename Char, typename Traits, typename Alloc>
+bool operator>=(type_identity_t<std::basic_string_view<Char, Traits>> lhs,
+		const basic_small_string<N, Char, Traits, Alloc>& rhs) noexcept {
+    return rhs.compare(lhs) <= 0;
+}
+
+template <std::size_t N, typename Char, typename Traits, typename Alloc>
+std::basic_ostream<Char, Traits>& operator<<(std::basic_ostream<Char, Traits>& os,
+					     const basic_small_string<N, Char, Traits, Alloc>& str) {
+    return os << std::basic_string_view<Char, Traits>(str);
+}
+
+} // namespace ul
+
+namespace std {
+
+/// @brief Hashes the characters, giving the same result as the equivalent `std::basic_string_view`.
+template <std::size_t N, typename Char, typename Traits, typename Alloc>
+struct hash<ul::basic_small_string<N, Char, Traits, Alloc>> {
+    std::size_t operator()(const ul::basic_small_string<N, Char, Traits, Alloc>& str) const noexcept {
+	return hash<basic_string_view<Char, Traits>>{}(str);
+    }
+};
+
+} // namespace std
@@ -7,14 +7,21 @@
 
 #pragma once
 
+#include "allocator.hpp"
 #include "compressed_pair.hpp"
+#include "stats.hpp"
 #include "traits.hpp"
 
 #include <memory>
+#include <algorithm>
 #include <iterator>
 #include <utility>
 #include <tuple>
 #include <cstddef>
+#include <cstring>
+#include <new>
+#include <cstdint>
+#include <limits>
 #include <stdexcept>
 
 namespace ul {
@@ -36,9 +43,115 @@ struct list_construct_t {
 /// @brief Instance of the disambiguator tag ul::list_construct_t.
 inline constexpr list_construct_t list_construct{list_construct_t::do_not_use{}};
 
-/// Generic container.
-template <typename T, typename Alloc = std::allocator<T>>
-class small_vector_base {
+namespace detail {
+
+template <typename It>
+using enable_if_iterator_t = std::enable_if_t<
+    std::is_base_of_v<std::input_iterator_tag, typename std::iterator_traits<It>::iterator_category>
+>;
+
+template <typename It>
+inline constexpr bool is_forward_iterator_v =
+    std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<It>::iterator_category>;
+
+/// Whether elements of type `T` can be copied from `It` using `memcpy`.
+template <typename It, typename T>
+inline constexpr bool is_memcpy_compatible_v =
+    is_contiguous_iterator_v<It> &&
+    std::is_trivially_copyable_v<T> &&
+    std::is_same_v<remove_cvref_t<typename std::iterator_traits<It>::reference>, T>;
+
+/// Destroys the elements in `[first, last)` through `alloc`.
+template <typename Alloc, typename T>
+void destroy_range(Alloc& alloc, T* first, T* last) noexcept {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+	for (; first != last; ++first) {
+	    std::allocator_traits<Alloc>::destroy(alloc, first);
+	}
+    }
+}
+
+/// Relocates the `tail` elements at `first` `n` positions towards the end, into memory
+/// which must be uninitialized past the elements.
+///
+/// Trivially relocatable elements are shifted with a single `memmove`. Other elements
+/// are relocated one at a time, starting from the back, and all of them are destroyed
+/// if one of them throws.
+template <typename Alloc, typename T>
+void open_gap(Alloc& alloc, T* first, std::size_t tail, std::size_t n) {
+    if constexpr (is_trivially_relocatable_v<T>) {
+	if (tail > 0) {
+	    std::memmove(static_cast<void*>(first + n), static_cast<const void*>(first), tail * sizeof(T));
+	}
+    }
+    else {
+	for (std::size_t i = tail; i > 0; --i) {
+	    T* src = first + i - 1;
+
+	    try {
+		std::allocator_traits<Alloc>::construct(alloc, src + n, std::move_if_noexcept(*src));
+	    }
+	    catch (...) {
+		destroy_range(alloc, first, src + 1);
+		destroy_range(alloc, src + n + 1, first + tail + n);
+		throw;
+	    }
+
+	    std::allocator_traits<Alloc>::destroy(alloc, src);
+	}
+    }
+}
+
+/// Undoes open_gap() after filling the gap failed.
+///
+/// Trivially relocatable elements are moved back, other elements are destroyed since
+/// moving them back could throw again.
+/// @return The number of elements left at `first`.
+template <typename Alloc, typename T>
+std::size_t close_gap(Alloc& alloc, T* first, std::size_t tail, std::size_t n) noexcept {
+    if constexpr (is_trivially_relocatable_v<T>) {
+	if (tail > 0) {
+	    std::memmove(static_cast<void*>(first), static_cast<const void*>(first + n), tail * sizeof(T));
+	}
+
+	return tail;
+    }
+    else {
+	destroy_range(alloc, first + n, first + n + tail);
+	return 0;
+    }
+}
+
+/// Removes the `n` elements at `first` and moves the `tail` elements following them
+/// into their place.
+template <typename Alloc, typename T>
+void erase_gap(Alloc& alloc, T* first, std::size_t tail, std::size_t n) {
+    if constexpr (is_trivially_relocatable_v<T>) {
+	destroy_range(alloc, first, first + n);
+
+	if (tail > 0) {
+	    std::memmove(static_cast<void*>(first), static_cast<const void*>(first + n), tail * sizeof(T));
+	}
+    }
+    else {
+	T* new_end = std::move(first + n, first + n + tail, first);
+	destroy_range(alloc, new_end, first + n + tail);
+    }
+}
+
+} // namespace detail
+
+/// @brief Generic container.
+///
+/// Holds everything a vector needs except for the inline buffer, which is owned by
+/// ul::small_vector and placed directly after the `small_vector_base` subobject.
+/// A `small_vector_base` on its own behaves like a vector with no inline capacity.
+///
+/// `Size` is the type used to store the size and capacity, a 32-bit type gives a
+/// 16 byte header on 64-bit platforms, see ul::compact_small_vector.
+template <typename T, typename Alloc = std::allocator<T>,
+	  typename Size = typename std::allocator_traits<Alloc>::size_type>
+class small_vector_base : private detail::stats_hook {
     using alloc_traits = std::allocator_traits<Alloc>;
 
 public:
@@ -46,7 +159,7 @@ public:
     /// @{
     using value_type = T;
     using allocator_type = Alloc;
-    using size_type = typename alloc_traits::size_type;
+    using size_type = Size;
     using difference_type = typename alloc_traits::difference_type;
     using reference = value_type&;
     using const_reference = const value_type&;
@@ -58,42 +171,75 @@ public:
     using const_reverse_iterator = std::reverse_iterator<const_iterator>;
     /// @}
 
-    explicit small_vector_base(const allocator_type& alloc = allocator_type{})
-	: m_data_and_alloc(nullptr, alloc) {}
+    explicit small_vector_base(const allocator_type& alloc = allocator_type{} UMLAUT_CALL_SITE_PARAM)
+	: small_vector_base(0, alloc, UMLAUT_CALL_SITE) {}
 
     /// @brief Constructs the `vector` from a list of values.
     template <typename ...Ts, typename = std::enable_if_t<
         !std::is_same_v<remove_cvref_t<pack_element_t<0, Ts...>>, allocator_type>
     >>
-    small_vector_base(list_construct_t, Ts&&... values)
-	: small_vector_base(list_construct, allocator_type{}, std::forward<Ts>(values)...) {}
+    small_vector_base(detail::call_site_tag<list_construct_t> tag, Ts&&... values)
+	: small_vector_base(tag, allocator_type{}, std::forward<Ts>(values)...) {}
 
     template <typename ...Ts>
-    small_vector_base(list_construct_t, const allocator_type& alloc, Ts&&... values)
-	: small_vector_base(alloc) {
-	reserve(sizeof...(values));
-	(emplace_back(std::forward<Ts>(values)), ...);
+    small_vector_base(detail::call_site_tag<list_construct_t> tag, const allocator_type& alloc,
+		      Ts&&... values)
+	: small_vector_base(0, alloc, tag.site) {
+	list_fill(std::forward<Ts>(values)...);
     }
 
     template <typename ...Tuples, typename = std::enable_if_t<
         !std::is_same_v<remove_cvref_t<pack_element_t<0, Tuples...>>, allocator_type>
     >>
-    small_vector_base(std::piecewise_construct_t, Tuples&&... tuples)
-	: small_vector_base(std::piecewise_construct, allocator_type{},
-			    std::forward<Tuples>(tuples)...) {}
+    small_vector_base(detail::call_site_tag<std::piecewise_construct_t> tag, Tuples&&... tuples)
+	: small_vector_base(tag, allocator_type{}, std::forward<Tuples>(tuples)...) {}
 
     template <typename ...Tuples>
-    small_vector_base(std::piecewise_construct_t, const allocator_type& alloc, Tuples&&... tuples)
-	: small_vector_base(alloc) {
-	reserve(sizeof...(tuples));
+    small_vector_base(detail::call_site_tag<std::piecewise_construct_t> tag,
+		      const allocator_type& alloc, Tuples&&... tuples)
+	: small_vector_base(0, alloc, tag.site) {
+	piecewise_fill(std::forward<Tuples>(tuples)...);
+    }
 
-	auto forwarding_lambda = [this](auto&&... args) {
-	    this->emplace_back(std::forward<decltype(args)>(args)...);
-	};
+    small_vector_base(const small_vector_base& other)
+	: small_vector_base(0, alloc_traits::select_on_container_copy_construction(other.m_alloc())) {
+	track_copy(other);
+	copy_from(other);
+    }
 
-	(std::apply(forwarding_lambda, tuples), ...);
+    small_vector_base(small_vector_base&& other)
+	: small_vector_base(0, std::move(other.m_alloc())) {
+	track_move(other);
+	move_from(other, 0);
     }
 
+    ~small_vector_base() {
+	record_destruction(m_size);
+	destroy_range(begin(), end());
+	deallocate_heap();
+    }
+
+    small_vector_base& operator=(const small_vector_base& other) {
+	if (this != &other) {
+	    assign(other.begin(), other.end());
+	}
+
+	return *this;
+    }
+
+    /// @brief Move assignment operator.
+    ///
+    /// Steals the heap allocation of `other` if it has one. Since the inline capacity
+    /// of `other` is unknown here it is left with a capacity of zero, use the
+    /// assignment operators of ul::small_vector to keep it.
+    small_vector_base& operator=(small_vector_base&& other) {
+	move_assign(other, 0);
+	return *this;
+    }
+
+    /// @brief Returns the allocator associated with the `vector`.
+    constexpr allocator_type get_allocator() const noexcept { return m_alloc(); }
+
     /// @name Element access
     /// @{
 
@@ -110,24 +256,24 @@ public:
 
     /// @brief Const overload of small_vector_base::data().
     constexpr const value_type* data() const noexcept {
-	return static_cast<value_type*>(m_data());
+	return static_cast<const value_type*>(m_data());
     }
     /// @}
 
     /// @name Iterators
     /// @{
-    constexpr iterator begin() noexcept { return &data()[0]; }
-    constexpr const_iterator cbegin() noexcept { return &data()[0]; }
-    constexpr const_iterator begin() const noexcept { return &data()[0]; }
-    constexpr iterator end() noexcept { return &data()[m_size]; }
-    constexpr const_iterator cend() noexcept { return &data()[m_size]; }
-    constexpr const_iterator end() const noexcept { return &data()[m_size]; }
-    constexpr reverse_iterator rbegin() noexcept { return &data()[m_size]; }
-    constexpr const_reverse_iterator crbegin() noexcept { return &data()[m_size]; }
-    constexpr const_reverse_iterator rbegin() const noexcept { return &data()[m_size]; }
-    constexpr reverse_iterator rend() noexcept { return &data()[0]; }
-    constexpr const_reverse_iterator crend() noexcept { return &data()[0]; }
-    constexpr const_reverse_iterator rend() const noexcept { return &data()[0]; }
+    constexpr iterator begin() noexcept { return data(); }
+    constexpr const_iterator cbegin() const noexcept { return data(); }
+    constexpr const_iterator begin() const noexcept { return data(); }
+    constexpr iterator end() noexcept { return data() + m_size; }
+    constexpr const_iterator cend() const noexcept { return data() + m_size; }
+    constexpr const_iterator end() const noexcept { return data() + m_size; }
+    constexpr reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    constexpr const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(end()); }
+    constexpr const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    constexpr reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    constexpr const_reverse_iterator crend() const noexcept { return const_reverse_iterator(begin()); }
+    constexpr const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
     /// @}
 
     /// @name Modifiers
@@ -147,12 +293,353 @@ public:
     /// @return Reference to the constructed element.
     template <typename ...Args>
     value_type& emplace_back(Args&&... args) {
-	// TODO:
-	// reallocate if m_size == m_capacity
+	if (UMLAUT_UNLIKELY(m_size == m_capacity)) {
+	    return grow_and_emplace(m_size, std::forward<Args>(args)...);
+	}
+
+	alloc_traits::construct(m_alloc(), data() + m_size, std::forward<Args>(args)...);
+
+	return data()[m_size++];
+    }
+
+    /// @brief Adds an element to the end of the `vector` without checking the capacity.
+    ///
+    /// The `vector` must have room for the element, f.e. by a prior call to
+    /// small_vector_base::reserve(). This is only checked if `UMLAUT_ENABLE_ASSERTS` is set.
+    void push_back_unchecked(const value_type& value) { emplace_back_unchecked(value); }
+
+    /// @brief Overload taking an rvalue reference.
+    void push_back_unchecked(value_type&& value) { emplace_back_unchecked(std::move(value)); }
+
+    /// @brief Constructs an element in place at the end of the `vector` without checking
+    /// the capacity.
+    ///
+    /// Same as small_vector_base::emplace_back() but without the branch which grows the
+    /// `vector`, see small_vector_base::push_back_unchecked().
+    /// @return Reference to the constructed element.
+    template <typename ...Args>
+    value_type& emplace_back_unchecked(Args&&... args) {
+	UMLAUT_ASSERT(m_size < m_capacity, "small_vector_base: capacity exceeded");
 
-	alloc_traits::construct(m_alloc(), &data()[m_size], std::forward<Args>(args)...);
+	alloc_traits::construct(m_alloc(), data() + m_size, std::forward<Args>(args)...);
 
-	return data()[++m_size];
+	return data()[m_size++];
+    }
+
+    /// @brief Constructs an element in place before `pos`.
+    ///
+    /// The elements after `pos` are relocated one position towards the end, which is a
+    /// single `memmove` for trivially relocatable types.
+    /// @return Iterator to the constructed element.
+    template <typename ...Args>
+    iterator emplace(const_iterator pos, Args&&... args) {
+	const auto index = static_cast<size_type>(pos - cbegin());
+
+	if (index == m_size) {
+	    emplace_back(std::forward<Args>(args)...);
+	}
+	else if (UMLAUT_UNLIKELY(m_size == m_capacity)) {
+	    grow_and_emplace(index, std::forward<Args>(args)...);
+	}
+	else {
+	    // args may refer to an element which is about to be relocated
+	    value_type value(std::forward<Args>(args)...);
+	    insert_one(pos, std::move(value));
+	}
+
+	return begin() + index;
+    }
+
+    /// @brief Inserts `value` before `pos`.
+    /// @return Iterator to the inserted element.
+    iterator insert(const_iterator pos, const value_type& value) { return insert_one(pos, value); }
+
+    /// @brief Overload taking an rvalue reference.
+    iterator insert(const_iterator pos, value_type&& value) { return insert_one(pos, std::move(value)); }
+
+    /// @brief Inserts `count` copies of `value` before `pos`.
+    /// @return Iterator to the first inserted element.
+    iterator insert(const_iterator pos, size_type count, const value_type& value) {
+	const auto index = static_cast<size_type>(pos - cbegin());
+
+	if (count == 0) {
+	    return begin() + index;
+	}
+
+	if (count > m_capacity - m_size) {
+	    const size_type new_cap = recommended_capacity(checked_new_size(count));
+	    pointer new_data = allocate_heap(new_cap);
+
+	    try {
+		construct_fill(new_data + index, count, value);
+	    }
+	    catch (...) {
+		alloc_traits::deallocate(m_alloc(), new_data, new_cap);
+		throw;
+	    }
+
+	    try {
+		relocate_around_gap(new_data, index, count);
+	    }
+	    catch (...) {
+		destroy_range(new_data + index, new_data + index + count);
+		alloc_traits::deallocate(m_alloc(), new_data, new_cap);
+		throw;
+	    }
+
+	    replace_storage(new_data, new_cap);
+	    m_size += count;
+	}
+	else {
+	    const value_type* ptr = std::addressof(value);
+	    const size_type tail = open_gap(index, count);
+
+	    if (ptr >= data() + index && ptr < data() + index + tail) {
+		ptr = data() + (ptr - data()) + count;
+	    }
+
+	    try {
+		construct_fill(data() + index, count, *ptr);
+	    }
+	    catch (...) {
+		close_gap(index, count, tail);
+		throw;
+	    }
+
+	    m_size = index + count + tail;
+	}
+
+	return begin() + index;
+    }
+
+    /// @brief Removes the element at `pos`.
+    /// @return Iterator following the removed element.
+    iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+
+    /// @brief Removes the elements in `[first, last)`.
+    ///
+    /// Trivially relocatable elements after the removed range are moved down with a
+    /// single `memmove`, other elements are move assigned.
+    /// @return Iterator following the last removed element.
+    iterator erase(const_iterator first, const_iterator last) {
+	const auto index = static_cast<size_type>(first - cbegin());
+	const auto count = static_cast<size_type>(last - first);
+	pointer pos = data() + index;
+
+	if (count > 0) {
+	    detail::erase_gap(m_alloc(), pos, m_size - index - count, count);
+	    m_size -= count;
+	}
+
+	return begin() + index;
+    }
+
+    /// @brief Removes the last element of the `vector`.
+    void pop_back() {
+	--m_size;
+	alloc_traits::destroy(m_alloc(), data() + m_size);
+    }
+
+    /// @brief Removes all elements of the `vector` but leaves the capacity unchanged.
+    void clear() noexcept {
+	destroy_range(begin(), end());
+	m_size = 0;
+    }
+
+    /// @brief Resizes the `vector` to `count` elements, new elements are value initialized.
+    void resize(size_type count) {
+	if (count < m_size) {
+	    erase(begin() + count, end());
+	}
+	else if (count > m_size) {
+	    if (count > m_capacity) {
+		reallocate(recommended_capacity(count));
+	    }
+
+	    pointer current = data() + m_size;
+
+	    try {
+		for (; current != data() + count; ++current) {
+		    alloc_traits::construct(m_alloc(), current);
+		}
+	    }
+	    catch (...) {
+		destroy_range(data() + m_size, current);
+		throw;
+	    }
+
+	    m_size = count;
+	}
+    }
+
+    /// @brief Resizes the `vector` to `count` elements, new elements are default initialized.
+    ///
+    /// Unlike small_vector_base::resize() trivial types such as integers are left
+    /// uninitialized, which avoids zero filling memory that is about to be overwritten
+    /// anyway. The allocator is bypassed when constructing the new elements, see
+    /// ul::default_init_allocator for making small_vector_base::resize() behave the same.
+    void resize_for_overwrite(size_type count) {
+	if (count < m_size) {
+	    erase(begin() + count, end());
+	}
+	else if (count > m_size) {
+	    if (count > m_capacity) {
+		reallocate(recommended_capacity(count));
+	    }
+
+	    if constexpr (!std::is_trivially_default_constructible_v<value_type>) {
+		pointer current = data() + m_size;
+
+		try {
+		    for (; current != data() + count; ++current) {
+			::new (static_cast<void*>(current)) value_type;
+		    }
+		}
+		catch (...) {
+		    destroy_range(data() + m_size, current);
+		    throw;
+		}
+	    }
+
+	    m_size = count;
+	}
+    }
+
+    /// @brief Resizes the `vector` to `count` elements, new elements are copies of `value`.
+    void resize(size_type count, const value_type& value) {
+	if (count < m_size) {
+	    erase(begin() + count, end());
+	}
+	else if (count > m_size) {
+	    const value_type* ptr = std::addressof(value);
+
+	    if (count > m_capacity) {
+		const bool is_element = ptr >= data() && ptr < data() + m_size;
+		const auto offset = ptr - data();
+
+		reallocate(recommended_capacity(count));
+
+		if (is_element) {
+		    ptr = data() + offset;
+		}
+	    }
+
+	    construct_fill(data() + m_size, count - m_size, *ptr);
+	    m_size = count;
+	}
+    }
+
+    /// @brief Appends copies of the elements in `[first, last)` to the end of the `vector`.
+    ///
+    /// For forward iterators the final size is computed up front so the `vector` grows
+    /// at most once. Contiguous ranges of trivially copyable elements are copied with a
+    /// single `memmove`. The range must not refer to elements of the `vector` itself.
+    template <typename InputIt, typename = detail::enable_if_iterator_t<InputIt>>
+    void append(InputIt first, InputIt last) {
+	if constexpr (detail::is_forward_iterator_v<InputIt>) {
+	    const size_type new_size = checked_new_size(static_cast<std::size_t>(std::distance(first, last)));
+
+	    if (new_size > m_capacity) {
+		reallocate(recommended_capacity(new_size));
+	    }
+
+	    construct_range(first, last, data() + m_size);
+	    m_size = new_size;
+	}
+	else {
+	    for (; first != last; ++first) {
+		emplace_back(*first);
+	    }
+	}
+    }
+
+    /// @brief Inserts copies of the elements in `[first, last)` before `pos`.
+    ///
+    /// Has the same growth behaviour as small_vector_base::append(). The elements after
+    /// `pos` are relocated to make room for the new ones. The range must not refer to
+    /// elements of the `vector` itself.
+    /// @return Iterator to the first inserted element.
+    template <typename InputIt, typename = detail::enable_if_iterator_t<InputIt>>
+    iterator insert(const_iterator pos, InputIt first, InputIt last) {
+	const auto index = static_cast<size_type>(pos - cbegin());
+
+	if constexpr (detail::is_forward_iterator_v<InputIt>) {
+	    const size_type new_size = checked_new_size(static_cast<std::size_t>(std::distance(first, last)));
+	    const size_type n = new_size - m_size;
+
+	    if (n == 0) {
+		return begin() + index;
+	    }
+
+	    if (new_size > m_capacity) {
+		const size_type new_cap = recommended_capacity(new_size);
+		pointer new_data = allocate_heap(new_cap);
+
+		try {
+		    construct_range(first, last, new_data + index);
+		}
+		catch (...) {
+		    alloc_traits::deallocate(m_alloc(), new_data, new_cap);
+		    throw;
+		}
+
+		try {
+		    relocate_around_gap(new_data, index, n);
+		}
+		catch (...) {
+		    destroy_range(new_data + index, new_data + index + n);
+		    alloc_traits::deallocate(m_alloc(), new_data, new_cap);
+		    throw;
+		}
+
+		replace_storage(new_data, new_cap);
+		m_size += n;
+	    }
+	    else {
+		const size_type tail = open_gap(index, n);
+
+		try {
+		    construct_range(first, last, data() + index);
+		}
+		catch (...) {
+		    close_gap(index, n, tail);
+		    throw;
+		}
+
+		m_size = index + n + tail;
+	    }
+	}
+	else {
+	    const size_type old_size = m_size;
+	    append(first, last);
+	    std::rotate(begin() + index, begin() + old_size, end());
+	}
+
+	return begin() + index;
+    }
+
+    /// @brief Replaces the elements of the `vector` with copies of the elements in
+    /// `[first, last)`.
+    ///
+    /// Has the same growth behaviour as small_vector_base::append() except that the new
+    /// capacity is exactly the size of the range when the `vector` has to grow.
+    template <typename InputIt, typename = detail::enable_if_iterator_t<InputIt>>
+    void assign(InputIt first, InputIt last) {
+	clear();
+
+	if constexpr (detail::is_forward_iterator_v<InputIt>) {
+	    const size_type n = checked_new_size(static_cast<std::size_t>(std::distance(first, last)));
+
+	    if (n > m_capacity) {
+		replace_storage(allocate_heap(n), n);
+	    }
+
+	    construct_range(first, last, data());
+	    m_size = n;
+	}
+	else {
+	    append(first, last);
+	}
     }
     /// @}
 
@@ -168,16 +655,20 @@ public:
 	    throw std::length_error("reserve");
 	}
 	else if (new_cap > capacity()) {
-	    auto new_data = alloc_traits::allocate(m_alloc(), new_cap);
+	    reallocate(new_cap);
+	}
+    }
 
-	    if (m_size > 0) {
-		// TODO:
-		// move old data to new allocation
-	    }
+    class fill_guard;
 
-	    m_data() = new_data;
-	    m_capacity = new_cap;
+    /// @brief Reserves room for `count` more elements and returns a ul::small_vector_base::fill_guard
+    /// appending to the `vector` without any capacity checks.
+    fill_guard reserve_fill(size_type count) {
+	if (count > m_capacity - m_size) {
+	    reserve(checked_new_size(count));
 	}
+
+	return fill_guard(*this, count);
     }
 
     /// @brief Returns the numbers of elements in the `vector`.
@@ -191,19 +682,837 @@ public:
     constexpr bool empty() const noexcept { return m_size == 0; }
 
     /// @brief Returns the maximum size the can have vector.
-    constexpr size_type max_size() const noexcept { return alloc_traits::max_size(m_alloc()); }
+    constexpr size_type max_size() const noexcept {
+	constexpr auto size_max = std::numeric_limits<size_type>::max();
+	const auto alloc_max = alloc_traits::max_size(m_alloc());
+
+	return alloc_max < size_max ? static_cast<size_type>(alloc_max) : size_max;
+    }
+
+    /// @brief Reduces the capacity of the `vector` to its size.
+    ///
+    /// A heap allocated `vector` is reallocated to exactly `size()` elements. Since the
+    /// inline capacity is unknown here the heap allocation is only released if the
+    /// `vector` is empty, ul::small_vector::shrink_to_fit() also moves the elements back
+    /// into the inline buffer.
+    void shrink_to_fit() { shrink(0, true); }
+
+    /// @brief Returns whether the elements are stored in the inline buffer or not.
+    ///
+    /// A `vector` without an inline buffer, or one left without it by a move through a
+    /// `small_vector_base` reference, has no storage at all and counts as inline.
+    bool is_inline() const noexcept { return m_data() == inline_data() || m_data() == pointer(); }
+    /// @}
+
+ protected:
+    /// @brief Constructs an empty `vector` using the `inline_capacity` elements of storage
+    /// placed directly after the `small_vector_base` subobject.
+    small_vector_base(size_type inline_capacity, const allocator_type& alloc)
+	: m_data_and_alloc(empty_data(inline_capacity), alloc), m_capacity(inline_capacity) {}
+
+    /// @brief Constructs an empty `vector` like above and records it as constructed at `site`.
+    small_vector_base(size_type inline_capacity, const allocator_type& alloc,
+		      const detail::call_site& site)
+	: small_vector_base(inline_capacity, alloc) {
+	track(site);
+    }
+
+    /// @name Statistics
+    /// Records the `vector` in the statistics enabled by `UMLAUT_ENABLE_STATS`, see stats.hpp.
+    /// @{
+    void track(const detail::call_site& site) { stats_hook::track(site); }
+    void track_copy(const small_vector_base& other) noexcept { stats_hook::track_copy(other); }
+    void track_move(small_vector_base& other) noexcept { stats_hook::track_move(other); }
     /// @}
 
+    /// @brief Returns a pointer to the inline buffer following the `small_vector_base`.
+    ///
+    /// The buffer of a ul::small_vector is placed at the first suitably aligned offset
+    /// after the `small_vector_base` subobject, so it can be found from the layout of the
+    /// base alone without knowing the inline capacity.
+    pointer inline_data() const noexcept {
+	// a derived class may place its members in the tail padding of a base class, which
+	// would make the offset below point past the inline buffer
+	static_assert((sizeof(m_data_and_alloc) + 2 * sizeof(size_type) + stats_hook::size) %
+		      alignof(small_vector_base) == 0,
+		      "small_vector_base must not have any tail padding");
+
+	auto self = const_cast<unsigned char*>(reinterpret_cast<const unsigned char*>(this));
+	return reinterpret_cast<pointer>(self + inline_offset());
+    }
+
+    /// @brief Returns the offset of the inline buffer from the start of the object.
+    static constexpr std::size_t inline_offset() noexcept {
+	return (sizeof(small_vector_base) + alignof(value_type) - 1) / alignof(value_type) *
+	       alignof(value_type);
+    }
+
+    /// @brief Returns the data pointer of a `vector` with no heap allocation.
+    ///
+    /// Without an inline buffer `inline_data()` points past the object, possibly at memory
+    /// an allocation could return, so a null pointer is used instead.
+    pointer empty_data(size_type inline_capacity) const noexcept {
+	return inline_capacity > 0 ? inline_data() : pointer();
+    }
+
+    template <typename ...Ts>
+    void list_fill(Ts&&... values) {
+	reserve(sizeof...(values));
+	(emplace_back_unchecked(std::forward<Ts>(values)), ...);
+    }
+
+    template <typename ...Tuples>
+    void piecewise_fill(Tuples&&... tuples) {
+	reserve(sizeof...(tuples));
+
+	auto forwarding_lambda = [this](auto&&... args) {
+	    this->emplace_back_unchecked(std::forward<decltype(args)>(args)...);
+	};
+
+	(std::apply(forwarding_lambda, std::forward<Tuples>(tuples)), ...);
+    }
+
+    /// @brief Copies the elements of `other` into an empty `vector`.
+    void copy_from(const small_vector_base& other) {
+	reserve(other.size());
+	append(other.begin(), other.end());
+    }
+
+    /// @brief Releases unused heap memory.
+    ///
+    /// If the elements fit in the inline buffer of `inline_capacity` elements they are
+    /// relocated there and the heap allocation is released. Otherwise the `vector` is
+    /// reallocated to exactly `size()` elements if `exact` is set.
+    void shrink(size_type inline_capacity, bool exact) {
+	if (is_inline()) {
+	    return;
+	}
+
+	if (m_size <= inline_capacity) {
+	    pointer heap_data = m_data();
+	    const size_type heap_capacity = m_capacity;
+
+	    relocate(begin(), end(), inline_data());
+
+	    m_data() = empty_data(inline_capacity);
+	    m_capacity = inline_capacity;
+	    alloc_traits::deallocate(m_alloc(), heap_data, heap_capacity);
+	}
+	else if (exact && m_size < m_capacity) {
+	    reallocate(m_size);
+	}
+    }
+
+    /// @brief Replaces the elements with the ones of `other`, see small_vector_base::move_from().
+    void move_assign(small_vector_base& other, size_type other_inline_capacity) {
+	if (this != &other) {
+	    track_move(other);
+	    clear();
+	    move_from(other, other_inline_capacity);
+	}
+    }
+
+    /// @brief Moves the elements of `other` into an empty `vector`.
+    ///
+    /// The heap allocation of `other` is stolen when possible, `other` is then reset to
+    /// its inline buffer with a capacity of `other_inline_capacity`.
+    void move_from(small_vector_base& other, size_type other_inline_capacity) {
+	if (!other.is_inline() && can_steal_from(other)) {
+	    deallocate_heap();
+
+	    if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+		m_alloc() = std::move(other.m_alloc());
+	    }
+
+	    m_data() = other.m_data();
+	    m_size = other.m_size;
+	    m_capacity = other.m_capacity;
+
+	    other.m_data() = other.empty_data(other_inline_capacity);
+	    other.m_size = 0;
+	    other.m_capacity = other_inline_capacity;
+	}
+	else {
+	    reserve(other.size());
+
+	    if constexpr (is_trivially_relocatable_v<value_type>) {
+		relocate(other.begin(), other.end(), data());
+		m_size = other.m_size;
+	    }
+	    else {
+		for (auto& value : other) {
+		    alloc_traits::construct(m_alloc(), data() + m_size, std::move(value));
+		    ++m_size;
+		}
+
+		other.destroy_range(other.begin(), other.end());
+	    }
+
+	    other.m_size = 0;
+	}
+    }
+
+    /// @brief Swaps the elements with `other`, both having an inline buffer of
+    /// `inline_capacity` elements.
+    ///
+    /// Two heap allocations are swapped by pointer. An inline `vector` swapped with one
+    /// on the heap has its elements relocated into the inline buffer of the other, which
+    /// then takes over nothing but the pointer. Only two inline `vector`s swap their
+    /// elements, which for trivially relocatable types is a swap of bytes.
+    void swap(small_vector_base& other, size_type inline_capacity) {
+	if (this == &other) {
+	    return;
+	}
+
+	if (!is_inline() && !other.is_inline()) {
+	    std::swap(m_data(), other.m_data());
+	    std::swap(m_size, other.m_size);
+	    std::swap(m_capacity, other.m_capacity);
+	}
+	else if (is_inline() && other.is_inline()) {
+	    // a vector moved from through a small_vector_base reference is left without
+	    // storage rather than with its inline buffer
+	    m_data() = empty_data(inline_capacity);
+	    m_capacity = inline_capacity;
+	    other.m_data() = other.empty_data(inline_capacity);
+	    other.m_capacity = inline_capacity;
+
+	    small_vector_base& shorter = m_size < other.m_size ? *this : other;
+	    small_vector_base& longer = m_size < other.m_size ? other : *this;
+	    const size_type common = shorter.m_size;
+
+	    if constexpr (is_trivially_relocatable_v<value_type>) {
+		auto first = reinterpret_cast<unsigned char*>(shorter.data());
+		std::swap_ranges(first, first + common * sizeof(value_type),
+				 reinterpret_cast<unsigned char*>(longer.data()));
+		relocate(longer.begin() + common, longer.end(), shorter.data() + common);
+		shorter.m_size = longer.m_size;
+	    }
+	    else {
+		std::swap_ranges(shorter.begin(), shorter.end(), longer.begin());
+
+		for (iterator it = longer.begin() + common; it != longer.end(); ++it) {
+		    alloc_traits::construct(m_alloc(), shorter.end(), std::move(*it));
+		    ++shorter.m_size;
+		}
+
+		longer.destroy_range(longer.begin() + common, longer.end());
+	    }
+
+	    longer.m_size = common;
+	}
+	else {
+	    small_vector_base& inline_vector = is_inline() ? *this : other;
+	    small_vector_base& heap_vector = is_inline() ? other : *this;
+
+	    relocate(inline_vector.begin(), inline_vector.end(), heap_vector.inline_data());
+
+	    const size_type inline_size = inline_vector.m_size;
+
+	    inline_vector.m_data() = heap_vector.m_data();
+	    inline_vector.m_size = heap_vector.m_size;
+	    inline_vector.m_capacity = heap_vector.m_capacity;
+
+	    heap_vector.m_data() = heap_vector.empty_data(inline_capacity);
+	    heap_vector.m_size = inline_size;
+	    heap_vector.m_capacity = inline_capacity;
+	}
+
+	if constexpr (alloc_traits::propagate_on_container_swap::value) {
+	    using std::swap;
+	    swap(m_alloc(), other.m_alloc());
+	}
+    }
+
  private:
     compressed_pair<pointer, allocator_type> m_data_and_alloc;
     size_type m_size = 0;
     size_type m_capacity = 0;
 
     constexpr pointer& m_data() noexcept { return m_data_and_alloc.first(); }
-    constexpr const_pointer& m_data() const noexcept { return m_data_and_alloc.first(); }
+    constexpr const pointer& m_data() const noexcept { return m_data_and_alloc.first(); }
 
     constexpr allocator_type& m_alloc() noexcept { return m_data_and_alloc.second(); }
     constexpr const allocator_type& m_alloc() const noexcept { return m_data_and_alloc.second(); }
+
+    static constexpr bool can_reallocate =
+	is_trivially_relocatable_v<value_type> && is_reallocating_allocator_v<allocator_type>;
+
+    bool can_steal_from(const small_vector_base& other) const noexcept {
+	if constexpr (alloc_traits::propagate_on_container_move_assignment::value ||
+		      alloc_traits::is_always_equal::value) {
+	    return true;
+	}
+	else {
+	    return m_alloc() == other.m_alloc();
+	}
+    }
+
+    /// @brief Returns the capacity to grow to when at least `min_cap` elements are needed.
+    ///
+    /// The current capacity is scaled by the growth factor defined in config.hpp, which
+    /// gives amortized constant time insertion at the end.
+    /// @throws std::length_error if `min_cap > max_size()`.
+    size_type recommended_capacity(size_type min_cap) const {
+	constexpr size_type num = UMLAUT_GROWTH_FACTOR_NUM;
+	constexpr size_type den = UMLAUT_GROWTH_FACTOR_DEN;
+	static_assert(num > den, "the growth factor must be greater than one");
+
+	const size_type max = max_size();
+
+	if (UMLAUT_UNLIKELY(min_cap > max)) {
+	    throw std::length_error("small_vector_base");
+	}
+
+	if (m_capacity > max / num) {
+	    return max;
+	}
+
+	const size_type grown = m_capacity * num / den;
+	return grown > min_cap ? grown : min_cap;
+    }
+
+    /// @brief Returns the size after adding `count` elements.
+    /// @throws std::length_error if it would exceed `max_size()`.
+    size_type checked_new_size(std::size_t count) const {
+	if (UMLAUT_UNLIKELY(count > static_cast<std::size_t>(max_size() - m_size))) {
+	    throw std::length_error("small_vector_base");
+	}
+
+	return static_cast<size_type>(m_size + count);
+    }
+
+    /// @brief Slow path of small_vector_base::emplace_back() and small_vector_base::emplace()
+    /// when the `vector` is full.
+    ///
+    /// The new element is constructed before the old elements are relocated since `args`
+    /// may refer to an element of the `vector` itself.
+    template <typename ...Args>
+    value_type& grow_and_emplace(size_type index, Args&&... args) {
+	const size_type new_cap = recommended_capacity(checked_new_size(1));
+
+	if constexpr (can_reallocate) {
+	    if (!is_inline()) {
+		// `args` may refer to an element, so the new element is constructed before
+		// the allocation is resized and then relocated into place.
+		alignas(value_type) unsigned char buffer[sizeof(value_type)];
+		auto element = reinterpret_cast<pointer>(buffer);
+
+		alloc_traits::construct(m_alloc(), element, std::forward<Args>(args)...);
+
+		try {
+		    reallocate(new_cap);
+		}
+		catch (...) {
+		    alloc_traits::destroy(m_alloc(), element);
+		    throw;
+		}
+
+		const size_type tail = open_gap(index, 1);
+		std::memcpy(static_cast<void*>(data() + index), static_cast<const void*>(element),
+			    sizeof(value_type));
+		m_size = index + 1 + tail;
+
+		return data()[index];
+	    }
+	}
+
+	pointer new_data = allocate_heap(new_cap);
+
+	try {
+	    alloc_traits::construct(m_alloc(), new_data + index, std::forward<Args>(args)...);
+	}
+	catch (...) {
+	    alloc_traits::deallocate(m_alloc(), new_data, new_cap);
+	    throw;
+	}
+
+	try {
+	    relocate_around_gap(new_data, index, 1);
+	}
+	catch (...) {
+	    alloc_traits::destroy(m_alloc(), new_data + index);
+	    alloc_traits::deallocate(m_alloc(), new_data, new_cap);
+	    throw;
+	}
+
+	replace_storage(new_data, new_cap);
+	++m_size;
+
+	return data()[index];
+    }
+
+    /// @brief Inserts `value` before `pos`, `value` may refer to an element of the `vector`.
+    template <typename U>
+    iterator insert_one(const_iterator pos, U&& value) {
+	const auto index = static_cast<size_type>(pos - cbegin());
+
+	if (UMLAUT_UNLIKELY(m_size == m_capacity)) {
+	    grow_and_emplace(index, std::forward<U>(value));
+	    return begin() + index;
+	}
+
+	auto ptr = const_cast<value_type*>(std::addressof(value));
+	const size_type tail = open_gap(index, 1);
+
+	if (ptr >= data() + index && ptr < data() + index + tail) {
+	    ptr = data() + (ptr - data()) + 1;
+	}
+
+	try {
+	    if constexpr (std::is_rvalue_reference_v<U&&>) {
+		alloc_traits::construct(m_alloc(), data() + index, std::move(*ptr));
+	    }
+	    else {
+		alloc_traits::construct(m_alloc(), data() + index, std::as_const(*ptr));
+	    }
+	}
+	catch (...) {
+	    close_gap(index, 1, tail);
+	    throw;
+	}
+
+	m_size = index + 1 + tail;
+
+	return begin() + index;
+    }
+
+    /// @brief Relocates the elements in `[first, last)` to the uninitialized memory at `dest`.
+    ///
+    /// Trivially relocatable types are copied with a single `memcpy`. Other types are
+    /// moved if their move constructor is `noexcept` and copied otherwise, which leaves
+    /// the source untouched if an exception is thrown.
+    void relocate(iterator first, iterator last, pointer dest) {
+	if constexpr (is_trivially_relocatable_v<value_type>) {
+	    if (first != last) {
+		std::memcpy(static_cast<void*>(dest), static_cast<const void*>(first),
+			    static_cast<std::size_t>(last - first) * sizeof(value_type));
+	    }
+	}
+	else {
+	    pointer current = dest;
+
+	    try {
+		for (iterator it = first; it != last; ++it, ++current) {
+		    alloc_traits::construct(m_alloc(), current, std::move_if_noexcept(*it));
+		}
+	    }
+	    catch (...) {
+		destroy_range(dest, current);
+		throw;
+	    }
+
+	    destroy_range(first, last);
+	}
+    }
+
+    /// @brief Allocates storage for `n` elements on the heap.
+    ///
+    /// A `vector` without an inline buffer has `inline_data()` pointing just past it, which
+    /// an allocation can return if the `vector` itself was allocated. Such an allocation
+    /// would be taken for the inline buffer and is therefore replaced by another one.
+    pointer allocate_heap(size_type n) {
+	pointer ptr = alloc_traits::allocate(m_alloc(), n);
+
+	if (UMLAUT_UNLIKELY(is_at_inline_data(ptr))) {
+	    pointer other;
+
+	    try {
+		other = alloc_traits::allocate(m_alloc(), n);
+	    }
+	    catch (...) {
+		alloc_traits::deallocate(m_alloc(), ptr, n);
+		throw;
+	    }
+
+	    alloc_traits::deallocate(m_alloc(), ptr, n);
+	    ptr = other;
+	}
+
+	return ptr;
+    }
+
+    /// @brief Checks whether `ptr` points at the inline buffer.
+    ///
+    /// Compares addresses, comparing the pointers lets GCC substitute `inline_data()` for
+    /// `ptr` and warn about deallocating it.
+    bool is_at_inline_data(pointer ptr) const noexcept {
+	return reinterpret_cast<std::uintptr_t>(std::addressof(*ptr)) ==
+	       reinterpret_cast<std::uintptr_t>(std::addressof(*inline_data()));
+    }
+
+    /// @brief Moves the elements to a new allocation of `new_cap` elements.
+    ///
+    /// Trivially relocatable elements on the heap are moved by resizing the allocation
+    /// in place when the allocator supports it, see ul::is_reallocating_allocator.
+    void reallocate(size_type new_cap) {
+	if constexpr (can_reallocate) {
+	    if (!is_inline()) {
+		const auto old_address = reinterpret_cast<std::uintptr_t>(m_data());
+		m_data() = m_alloc().reallocate(m_data(), m_capacity, new_cap);
+		m_capacity = new_cap;
+
+		if (UMLAUT_UNLIKELY(is_at_inline_data(m_data()))) {
+		    // see allocate_heap(), the elements are moved once more
+		    pointer new_data = allocate_heap(new_cap);
+		    relocate(begin(), end(), new_data);
+		    alloc_traits::deallocate(m_alloc(), m_data(), new_cap);
+		    m_data() = new_data;
+		}
+
+		// an allocation resized in place copied nothing
+		const bool moved = reinterpret_cast<std::uintptr_t>(m_data()) != old_address;
+		record_growth(false, moved ? m_size * sizeof(value_type) : 0);
+		return;
+	    }
+	}
+
+	pointer new_data = allocate_heap(new_cap);
+
+	try {
+	    relocate(begin(), end(), new_data);
+	}
+	catch (...) {
+	    alloc_traits::deallocate(m_alloc(), new_data, new_cap);
+	    throw;
+	}
+
+	replace_storage(new_data, new_cap);
+    }
+
+    /// @brief Relocates all elements to `new_data` leaving room for `n` elements at `index`.
+    ///
+    /// Like small_vector_base::relocate() the old elements are only destroyed once all of
+    /// them have been constructed at their new location.
+    void relocate_around_gap(pointer new_data, size_type index, size_type n) {
+	if constexpr (is_trivially_relocatable_v<value_type>) {
+	    relocate(begin(), begin() + index, new_data);
+
+	    // appending leaves no tail, and GCC warns about the empty copy past the buffer
+	    if (index < m_size) {
+		relocate(begin() + index, end(), new_data + index + n);
+	    }
+	}
+	else {
+	    pointer current = new_data;
+
+	    try {
+		for (size_type i = 0; i < m_size; ++i, ++current) {
+		    if (i == index) {
+			current += n;
+		    }
+
+		    alloc_traits::construct(m_alloc(), current, std::move_if_noexcept(data()[i]));
+		}
+	    }
+	    catch (...) {
+		destroy_range(new_data, current < new_data + index ? current : new_data + index);
+		destroy_range(new_data + index + n, current > new_data + index + n ? current : new_data + index + n);
+		throw;
+	    }
+
+	    destroy_range(begin(), end());
+	}
+    }
+
+    /// @brief Relocates the elements in `[index, size())` `n` positions towards the end.
+    ///
+    /// The capacity must already be large enough. Until the gap is filled the size of the
+    /// `vector` is `index`, which keeps it destructible if filling the gap throws.
+    /// @return The number of relocated elements.
+    size_type open_gap(size_type index, size_type n) {
+	const size_type tail = m_size - index;
+
+	m_size = index;
+	detail::open_gap(m_alloc(), data() + index, tail, n);
+
+	return tail;
+    }
+
+    /// @brief Undoes small_vector_base::open_gap() after filling the gap failed, see
+    /// detail::close_gap().
+    void close_gap(size_type index, size_type n, size_type tail) noexcept {
+	m_size = index + static_cast<size_type>(detail::close_gap(m_alloc(), data() + index, tail, n));
+    }
+
+    /// @brief Copy constructs the elements in `[first, last)` into the uninitialized
+    /// memory at `dest`.
+    ///
+    /// Already constructed elements are destroyed if an exception is thrown.
+    template <typename ForwardIt>
+    void construct_range(ForwardIt first, ForwardIt last, pointer dest) {
+	if constexpr (detail::is_memcpy_compatible_v<ForwardIt, value_type>) {
+	    if (first != last) {
+		std::memmove(static_cast<void*>(dest), static_cast<const void*>(std::addressof(*first)),
+			     static_cast<std::size_t>(std::distance(first, last)) * sizeof(value_type));
+	    }
+	}
+	else {
+	    pointer current = dest;
+
+	    try {
+		for (; first != last; ++first, ++current) {
+		    alloc_traits::construct(m_alloc(), current, *first);
+		}
+	    }
+	    catch (...) {
+		destroy_range(dest, current);
+		throw;
+	    }
+	}
+    }
+
+    /// @brief Copy constructs `count` copies of `value` into the uninitialized memory at `dest`.
+    ///
+    /// Already constructed elements are destroyed if an exception is thrown.
+    void construct_fill(pointer dest, size_type count, const value_type& value) {
+	pointer current = dest;
+
+	try {
+	    for (; current != dest + count; ++current) {
+		alloc_traits::construct(m_alloc(), current, value);
+	    }
+	}
+	catch (...) {
+	    destroy_range(dest, current);
+	    throw;
+	}
+    }
+
+    /// @brief Releases the current storage, whose elements have already been relocated,
+    /// and takes ownership of `new_data`.
+    void replace_storage(pointer new_data, size_type new_cap) noexcept {
+	record_growth(is_inline(), m_size * sizeof(value_type));
+	deallocate_heap();
+
+	m_data() = new_data;
+	m_capacity = new_cap;
+    }
+
+    void destroy_range(iterator first, iterator last) noexcept {
+	detail::destroy_range(m_alloc(), first, last);
+    }
+
+    void deallocate_heap() noexcept {
+	if (!is_inline()) {
+	    alloc_traits::deallocate(m_alloc(), m_data(), m_capacity);
+	}
+    }
 };
 
+/// @brief Scope guard appending to a ul::small_vector_base with reserved capacity.
+///
+/// The end of the `vector` is kept in the guard and the size of the `vector` is only
+/// updated when the guard is destroyed, which leaves the fill loop free of capacity
+/// checks and of stores to the `vector` itself. The `vector` must not be accessed while
+/// the guard is alive.
+template <typename T, typename Alloc, typename Size>
+class small_vector_base<T, Alloc, Size>::fill_guard {
+ public:
+    fill_guard(const fill_guard&) = delete;
+    fill_guard& operator=(const fill_guard&) = delete;
+
+    ~fill_guard() {
+	m_vector->m_size = static_cast<size_type>(m_current - m_vector->data());
+    }
+
+    /// @brief Adds an element to the end of the `vector`.
+    void push_back(const value_type& value) { emplace_back(value); }
+
+    /// @brief Overload taking an rvalue reference.
+    void push_back(value_type&& value) { emplace_back(std::move(value)); }
+
+    /// @brief Constructs an element in place at the end of the `vector`.
+    template <typename ...Args>
+    value_type& emplace_back(Args&&... args) {
+	UMLAUT_ASSERT(m_current != m_last, "small_vector_base::fill_guard: reserved capacity exceeded");
+
+	alloc_traits::construct(m_vector->m_alloc(), m_current, std::forward<Args>(args)...);
+
+	return *m_current++;
+    }
+
+ private:
+    friend class small_vector_base;
+
+    fill_guard(small_vector_base& vector, size_type count)
+	: m_vector(&vector), m_current(vector.end()), m_last(vector.end() + count) {}
+
+    small_vector_base* m_vector;
+    pointer m_current;
+    [[maybe_unused]] pointer m_last;
+};
+
+namespace detail {
+
+template <typename T, std::size_t N>
+struct small_vector_storage {
+    alignas(T) unsigned char m_buffer[N * sizeof(T)];
+};
+
+template <typename T>
+struct small_vector_storage<T, 0> {};
+
+} // namespace detail
+
+/// @brief Vector storing up to `N` elements inline before spilling to the heap.
+///
+/// The first `N` elements are kept in a buffer inside the object itself, the
+/// allocator is only used once the `vector` outgrows it.
+///
+/// All operations except for the ones needing `N`, such as shrinking back into the
+/// inline buffer, are implemented by ul::small_vector_base. Functions should therefore
+/// take a `small_vector_base<T, Alloc>&`, which accepts a `small_vector` of any inline
+/// capacity, rather than being templated on `N`.
+template <typename T, std::size_t N, typename Alloc = std::allocator<T>,
+	  typename Size = typename std::allocator_traits<Alloc>::size_type>
+class small_vector : public small_vector_base<T, Alloc, Size>,
+		     private detail::small_vector_storage<T, N> {
+    using base = small_vector_base<T, Alloc, Size>;
+    using storage = detail::small_vector_storage<T, N>;
+    using alloc_traits = std::allocator_traits<Alloc>;
+
+    static_assert(N <= std::numeric_limits<Size>::max(), "N does not fit in the size type");
+
+    static constexpr bool nothrow_relocatable =
+	is_trivially_relocatable_v<T> || std::is_nothrow_move_constructible_v<T>;
+
+public:
+    using typename base::value_type;
+    using typename base::allocator_type;
+    using typename base::size_type;
+
+    /// @brief Number of elements which fit in the inline buffer.
+    static constexpr size_type inline_capacity = N;
+
+    explicit small_vector(const allocator_type& alloc = allocator_type{} UMLAUT_CALL_SITE_PARAM)
+	: base(N, alloc, UMLAUT_CALL_SITE) {
+	static_assert(N == 0 || sizeof(small_vector) ==
+		      (base::inline_offset() + sizeof(storage) + alignof(small_vector) - 1) /
+		      alignof(small_vector) * alignof(small_vector),
+		      "the inline buffer must directly follow the small_vector_base subobject");
+    }
+
+    /// @brief Constructs the `vector` from a list of values.
+    template <typename ...Ts, typename = std::enable_if_t<
+        !std::is_same_v<remove_cvref_t<pack_element_t<0, Ts...>>, allocator_type>
+    >>
+    small_vector(detail::call_site_tag<list_construct_t> tag, Ts&&... values)
+	: small_vector(tag, allocator_type{}, std::forward<Ts>(values)...) {}
+
+    template <typename ...Ts>
+    small_vector(detail::call_site_tag<list_construct_t> tag, const allocator_type& alloc,
+		 Ts&&... values)
+	: base(N, alloc, tag.site) {
+	this->list_fill(std::forward<Ts>(values)...);
+    }
+
+    template <typename ...Tuples, typename = std::enable_if_t<
+        !std::is_same_v<remove_cvref_t<pack_element_t<0, Tuples...>>, allocator_type>
+    >>
+    small_vector(detail::call_site_tag<std::piecewise_construct_t> tag, Tuples&&... tuples)
+	: small_vector(tag, allocator_type{}, std::forward<Tuples>(tuples)...) {}
+
+    template <typename ...Tuples>
+    small_vector(detail::call_site_tag<std::piecewise_construct_t> tag, const allocator_type& alloc,
+		 Tuples&&... tuples)
+	: base(N, alloc, tag.site) {
+	this->piecewise_fill(std::forward<Tuples>(tuples)...);
+    }
+
+    small_vector(const small_vector& other)
+	: base(N, alloc_traits::select_on_container_copy_construction(other.get_allocator())) {
+	this->track_copy(other);
+	this->copy_from(other);
+    }
+
+    /// @brief Move constructor.
+    ///
+    /// Never allocates since the elements of `other` either fit in the inline buffer or
+    /// are stolen along with its heap allocation. Trivially relocatable elements stored
+    /// inline are moved with `memcpy`.
+    small_vector(small_vector&& other) noexcept(nothrow_relocatable)
+	: base(N, other.get_allocator()) {
+	this->track_move(other);
+	this->move_from(other, N);
+    }
+
+    /// @brief Copy constructs from a `vector` with any inline capacity.
+    small_vector(const base& other)
+	: base(N, alloc_traits::select_on_container_copy_construction(other.get_allocator())) {
+	this->track_copy(other);
+	this->copy_from(other);
+    }
+
+    /// @brief Move constructs from a `vector` with any inline capacity.
+    ///
+    /// See small_vector_base::operator=(small_vector_base&&) for the state of `other`.
+    small_vector(base&& other)
+	: base(N, other.get_allocator()) {
+	this->track_move(other);
+	this->move_from(other, 0);
+    }
+
+    small_vector& operator=(const small_vector& other) {
+	base::operator=(other);
+	return *this;
+    }
+
+    small_vector& operator=(small_vector&& other) noexcept(
+	nothrow_relocatable && (alloc_traits::propagate_on_container_move_assignment::value ||
+				alloc_traits::is_always_equal::value)) {
+	this->move_assign(other, N);
+	return *this;
+    }
+
+    /// @brief Copy assigns from a `vector` with any inline capacity.
+    small_vector& operator=(const base& other) {
+	base::operator=(other);
+	return *this;
+    }
+
+    /// @brief Move assigns from a `vector` with any inline capacity.
+    small_vector& operator=(base&& other) {
+	base::operator=(std::move(other));
+	return *this;
+    }
+
+    /// @brief Swaps the contents with `other`, see small_vector_base::swap().
+    void swap(small_vector& other) noexcept(nothrow_relocatable && std::is_nothrow_swappable_v<value_type>) {
+	base::swap(other, N);
+    }
+
+    friend void swap(small_vector& lhs, small_vector& rhs) noexcept(noexcept(lhs.swap(rhs))) {
+	lhs.swap(rhs);
+    }
+
+    /// @brief Reduces the capacity of the `vector` to its size.
+    ///
+    /// If the elements fit in the inline buffer they are relocated back into it and the
+    /// heap allocation is released, otherwise the `vector` is reallocated to exactly
+    /// `size()` elements.
+    void shrink_to_fit() { this->shrink(N, true); }
+
+    /// @brief Moves the elements back into the inline buffer if they fit.
+    ///
+    /// Unlike small_vector::shrink_to_fit() this never reallocates on the heap, so it is
+    /// cheap to call after every burst.
+    /// @return Whether the elements are stored in the inline buffer.
+    bool compact() {
+	this->shrink(N, false);
+	return this->is_inline();
+    }
+};
+
+/// @brief ul::small_vector_base storing its size and capacity as 32-bit integers.
+///
+/// Together with an empty allocator this gives a 16 byte header on 64-bit platforms,
+/// at the cost of limiting the size to `UINT32_MAX` elements.
+template <typename T, typename Alloc = std::allocator<T>>
+using compact_small_vector_base = small_vector_base<T, Alloc, std::uint32_t>;
+
+/// @brief ul::small_vector storing its size and capacity as 32-bit integers.
+template <typename T, std::size_t N, typename Alloc = std::allocator<T>>
+using compact_small_vector = small_vector<T, N, Alloc, std::uint32_t>;
+
 } // namespace ul
@@ -0,0 +1,539 @@
+/// @file
+/// Defines ul::static_vector.
+///
+/// @copyright Marcus Larsson 2018
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "small_vector.hpp"
+#include "special_members.hpp"
+#include "traits.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace ul {
+namespace detail {
+
+/// Smallest unsigned integer type able to store `N`.
+template <std::size_t N>
+using static_vector_size_t = std::conditional_t<
+    N <= std::numeric_limits<std::uint8_t>::max(), std::uint8_t,
+    std::conditional_t<
+	N <= std::numeric_limits<std::uint16_t>::max(), std::uint16_t,
+	std::conditional_t<N <= std::numeric_limits<std::uint32_t>::max(), std::uint32_t, std::size_t>
+    >
+>;
+
+template <typename T, std::size_t N, bool = std::is_trivially_copyable_v<T>>
+struct static_vector_storage {
+    static_vector_storage() noexcept : m_size(0) {}
+
+    T* data() noexcept { return reinterpret_cast<T*>(m_buffer); }
+    const T* data() const noexcept { return reinterpret_cast<const T*>(m_buffer); }
+
+    alignas(T) unsigned char m_buffer[N > 0 ? N * sizeof(T) : 1];
+    static_vector_size_t<N> m_size;
+};
+
+template <typename T, std::size_t N>
+struct static_vector_storage<T, N, false> : static_vector_storage<T, N, true> {
+    static_vector_storage() = default;
+
+    static_vector_storage(const static_vector_storage& other) {
+	copy_from(other);
+    }
+
+    static_vector_storage(static_vector_storage&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+	move_from(other);
+    }
+
+    ~static_vector_storage() {
+	destroy_all();
+    }
+
+    static_vector_storage& operator=(const static_vector_storage& other) {
+	if (this != &other) {
+	    destroy_all();
+	    copy_from(other);
+	}
+
+	return *this;
+    }
+
+    static_vector_storage& operator=(static_vector_storage&& other) noexcept(
+	std::is_nothrow_move_constructible_v<T>) {
+	if (this != &other) {
+	    destroy_all();
+	    move_from(other);
+	}
+
+	return *this;
+    }
+
+    void destroy_all() noexcept {
+	std::destroy(this->data(), this->data() + this->m_size);
+	this->m_size = 0;
+    }
+
+    void copy_from(const static_vector_storage& other) {
+	for (; this->m_size < other.m_size; ++this->m_size) {
+	    ::new (static_cast<void*>(this->data() + this->m_size)) T(other.data()[this->m_size]);
+	}
+    }
+
+    void move_from(static_vector_storage& other) {
+	for (; this->m_size < other.m_size; ++this->m_size) {
+	    ::new (static_cast<void*>(this->data() + this->m_size)) T(std::move(other.data()[this->m_size]));
+	}
+    }
+};
+
+} // namespace detail
+
+/// @brief Vector with a fixed capacity of `N` elements which never allocates.
+///
+/// Has the same interface as ul::small_vector_base, including the relocation based
+/// insertion and removal, but all elements are stored inside the object and exceeding
+/// the capacity throws `std::length_error`. A `static_vector` of a trivially copyable
+/// type is itself trivially copyable.
+template <typename T, std::size_t N>
+class static_vector : private detail::static_vector_storage<T, N>,
+		      private detail::delete_ctor_base<std::is_copy_constructible_v<T>,
+						       std::is_move_constructible_v<T>>,
+		      private detail::delete_assign_base<std::is_copy_constructible_v<T>,
+							 std::is_move_constructible_v<T>> {
+    using storage = detail::static_vector_storage<T, N>;
+
+public:
+    /// @name Aliases
+    /// @{
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using pointer = value_type*;
+    using const_pointer = const value_type*;
+    using iterator = value_type*;
+    using const_iterator = const value_type*;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+    /// @}
+
+    /// @brief A `static_vector` can be relocated with `memcpy` if its elements can.
+    using is_trivially_relocatable = ul::is_trivially_relocatable<T>;
+
+    static_vector() = default;
+
+    /// @brief Constructs the `vector` from a list of values.
+    template <typename ...Ts>
+    static_vector(list_construct_t, Ts&&... values) {
+	static_assert(sizeof...(values) <= N, "too many values for the capacity");
+	(emplace_back_unchecked(std::forward<Ts>(values)), ...);
+    }
+
+    template <typename ...Tuples>
+    static_vector(std::piecewise_construct_t, Tuples&&... tuples) {
+	static_assert(sizeof...(tuples) <= N, "too many values for the capacity");
+
+	auto forwarding_lambda = [this](auto&&... args) {
+	    this->emplace_back_unchecked(std::forward<decltype(args)>(args)...);
+	};
+
+	(std::apply(forwarding_lambda, std::forward<Tuples>(tuples)), ...);
+    }
+
+    /// @name Element access
+    /// @{
+
+    /// @brief Returns element at index `i`.
+    value_type& operator[](size_type i) { return data()[i]; }
+
+    /// @brief Const overload of `static_vector::operator[]`.
+    const value_type& operator[](size_type i) const { return data()[i]; }
+
+    /// @brief Returns a pointer to the underlying data of the `vector`.
+    value_type* data() noexcept { return storage::data(); }
+
+    /// @brief Const overload of static_vector::data().
+    const value_type* data() const noexcept { return storage::data(); }
+    /// @}
+
+    /// @name Iterators
+    /// @{
+    iterator begin() noexcept { return data(); }
+    const_iterator cbegin() const noexcept { return data(); }
+    const_iterator begin() const noexcept { return data(); }
+    iterator end() noexcept { return data() + size(); }
+    const_iterator cend() const noexcept { return data() + size(); }
+    const_iterator end() const noexcept { return data() + size(); }
+    reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator crend() const noexcept { return const_reverse_iterator(begin()); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+    /// @}
+
+    /// @name Modifiers
+    /// @{
+
+    /// @brief Adds an element to the end of the `vector`.
+    /// @throws std::length_error if the `vector` is full.
+    void push_back(const value_type& value) { emplace_back(value); }
+
+    /// @brief Overload taking an rvalue reference.
+    void push_back(value_type&& value) { emplace_back(std::move(value)); }
+
+    /// @brief Constructs an element in place at the end of the `vector`.
+    /// @throws std::length_error if the `vector` is full.
+    template <typename ...Args>
+    value_type& emplace_back(Args&&... args) {
+	check_room(1);
+	return emplace_back_unchecked(std::forward<Args>(args)...);
+    }
+
+    /// @brief Adds an element to the end of the `vector` without checking the capacity.
+    void push_back_unchecked(const value_type& value) { emplace_back_unchecked(value); }
+
+    /// @brief Overload taking an rvalue reference.
+    void push_back_unchecked(value_type&& value) { emplace_back_unchecked(std::move(value)); }
+
+    /// @brief Constructs an element in place at the end of the `vector` without checking
+    /// the capacity, see small_vector_base::emplace_back_unchecked().
+    template <typename ...Args>
+    value_type& emplace_back_unchecked(Args&&... args) {
+	UMLAUT_ASSERT(size() < N, "static_vector: capacity exceeded");
+
+	pointer ptr = ::new (static_cast<void*>(data() + size())) value_type(std::forward<Args>(args)...);
+	++this->m_size;
+
+	return *ptr;
+    }
+
+    /// @brief Constructs an element in place before `pos`.
+    /// @throws std::length_error if the `vector` is full.
+    template <typename ...Args>
+    iterator emplace(const_iterator pos, Args&&... args) {
+	const auto index = static_cast<size_type>(pos - cbegin());
+
+	if (index == size()) {
+	    emplace_back(std::forward<Args>(args)...);
+	}
+	else {
+	    check_room(1);
+
+	    // args may refer to an element which is about to be relocated
+	    value_type value(std::forward<Args>(args)...);
+	    const size_type tail = open_gap(index, 1);
+
+	    try {
+		::new (static_cast<void*>(data() + index)) value_type(std::move(value));
+	    }
+	    catch (...) {
+		close_gap(index, 1, tail);
+		throw;
+	    }
+
+	    set_size(index + 1 + tail);
+	}
+
+	return begin() + index;
+    }
+
+    /// @brief Inserts `value` before `pos`.
+    iterator insert(const_iterator pos, const value_type& value) { return emplace(pos, value); }
+
+    /// @brief Overload taking an rvalue reference.
+    iterator insert(const_iterator pos, value_type&& value) { return emplace(pos, std::move(value)); }
+
+    /// @brief Inserts `count` copies of `value` before `pos`.
+    iterator insert(const_iterator pos, size_type count, const value_type& value) {
+	const auto index = static_cast<size_type>(pos - cbegin());
+
+	if (count == 0) {
+	    return begin() + index;
+	}
+
+	check_room(count);
+
+	const value_type* ptr = std::addressof(value);
+	const size_type tail = open_gap(index, count);
+
+	if (ptr >= data() + index && ptr < data() + index + tail) {
+	    ptr += count;
+	}
+
+	try {
+	    construct_fill(data() + index, count, *ptr);
+	}
+	catch (...) {
+	    close_gap(index, count, tail);
+	    throw;
+	}
+
+	set_size(index + count + tail);
+
+	return begin() + index;
+    }
+
+    /// @brief Inserts copies of the elements in `[first, last)` before `pos`, see
+    /// small_vector_base::insert().
+    template <typename InputIt, typename = detail::enable_if_iterator_t<InputIt>>
+    iterator insert(const_iterator pos, InputIt first, InputIt last) {
+	const auto index = static_cast<size_type>(pos - cbegin());
+
+	if constexpr (detail::is_forward_iterator_v<InputIt>) {
+	    const auto count = static_cast<size_type>(std::distance(first, last));
+
+	    if (count == 0) {
+		return begin() + index;
+	    }
+
+	    check_room(count);
+
+	    const size_type tail = open_gap(index, count);
+
+	    try {
+		construct_range(first, last, data() + index);
+	    }
+	    catch (...) {
+		close_gap(index, count, tail);
+		throw;
+	    }
+
+	    set_size(index + count + tail);
+	}
+	else {
+	    const size_type old_size = size();
+	    append(first, last);
+	    std::rotate(begin() + index, begin() + old_size, end());
+	}
+
+	return begin() + index;
+    }
+
+    /// @brief Appends copies of the elements in `[first, last)`, see small_vector_base::append().
+    template <typename InputIt, typename = detail::enable_if_iterator_t<InputIt>>
+    void append(InputIt first, InputIt last) {
+	if constexpr (detail::is_forward_iterator_v<InputIt>) {
+	    const auto count = static_cast<size_type>(std::distance(first, last));
+	    check_room(count);
+
+	    construct_range(first, last, end());
+	    set_size(size() + count);
+	}
+	else {
+	    for (; first != last; ++first) {
+		emplace_back(*first);
+	    }
+	}
+    }
+
+    /// @brief Replaces the elements with copies of the elements in `[first, last)`.
+    template <typename InputIt, typename = detail::enable_if_iterator_t<InputIt>>
+    void assign(InputIt first, InputIt last) {
+	clear();
+	append(first, last);
+    }
+
+    /// @brief Removes the element at `pos`.
+    iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+
+    /// @brief Removes the elements in `[first, last)`, see small_vector_base::erase().
+    iterator erase(const_iterator first, const_iterator last) {
+	const auto index = static_cast<size_type>(first - cbegin());
+	const auto count = static_cast<size_type>(last - first);
+	pointer pos = data() + index;
+
+	if (count > 0) {
+	    std::allocator<value_type> alloc;
+	    detail::erase_gap(alloc, pos, size() - index - count, count);
+	    set_size(size() - count);
+	}
+
+	return begin() + index;
+    }
+
+    /// @brief Removes the last element of the `vector`.
+    void pop_back() {
+	--this->m_size;
+	std::destroy_at(data() + size());
+    }
+
+    /// @brief Removes all elements of the `vector`.
+    void clear() noexcept {
+	std::destroy(begin(), end());
+	this->m_size = 0;
+    }
+
+    /// @brief Resizes the `vector` to `count` elements, new elements are value initialized.
+    void resize(size_type count) {
+	resize_with(count, [](pointer dest) { ::new (static_cast<void*>(dest)) value_type(); });
+    }
+
+    /// @brief Resizes the `vector` to `count` elements, new elements are copies of `value`.
+    void resize(size_type count, const value_type& value) {
+	resize_with(count, [&value](pointer dest) { ::new (static_cast<void*>(dest)) value_type(value); });
+    }
+
+    /// @brief Resizes the `vector` to `count` elements, new elements are default initialized.
+    void resize_for_overwrite(size_type count) {
+	resize_with(count, [](pointer dest) { ::new (static_cast<void*>(dest)) value_type; });
+    }
+
+    /// @brief Swaps the elements with the ones of `other`.
+    ///
+    /// The elements both `vector`s have are swapped and the remaining ones of the
+    /// longer `vector` are relocated to the shorter one.
+    void swap(static_vector& other) noexcept(
+	std::is_nothrow_move_constructible_v<value_type> && std::is_nothrow_swappable_v<value_type>) {
+	static_vector& shorter = size() < other.size() ? *this : other;
+	static_vector& longer = size() < other.size() ? other : *this;
+	const size_type common = shorter.size();
+
+	std::swap_ranges(shorter.begin(), shorter.end(), longer.begin());
+
+	for (iterator it = longer.begin() + common; it != longer.end(); ++it) {
+	    shorter.emplace_back_unchecked(std::move(*it));
+	}
+
+	std::destroy(longer.begin() + common, longer.end());
+	longer.set_size(common);
+    }
+
+    friend void swap(static_vector& lhs, static_vector& rhs) noexcept(noexcept(lhs.swap(rhs))) {
+	lhs.swap(rhs);
+    }
+    /// @}
+
+    /// @name Capacity
+    /// @{
+
+    /// @brief Checks that `new_cap` elements fit in the `vector`.
+    /// @throws std::length_error if `new_cap > capacity()`.
+    void reserve(size_type new_cap) {
+	if (UMLAUT_UNLIKELY(new_cap > N)) {
+	    throw std::length_error("reserve");
+	}
+    }
+
+    /// @brief Returns the numbers of elements in the `vector`.
+    constexpr size_type size() const noexcept { return this->m_size; }
+
+    /// @brief Returns the number of elements the `vector` can hold.
+    static constexpr size_type capacity() noexcept { return N; }
+
+    /// @brief Returns whether the `vector` is empty of not.
+    constexpr bool empty() const noexcept { return size() == 0; }
+
+    /// @brief Returns the maximum size the can have vector.
+    static constexpr size_type max_size() noexcept { return N; }
+    /// @}
+
+ private:
+    void check_room(size_type count) const {
+	if (UMLAUT_UNLIKELY(count > N - size())) {
+	    throw std::length_error("static_vector");
+	}
+    }
+
+    template <typename ForwardIt>
+    static void construct_range(ForwardIt first, ForwardIt last, pointer dest) {
+	if constexpr (detail::is_memcpy_compatible_v<ForwardIt, value_type>) {
+	    if (first != last) {
+		std::memmove(static_cast<void*>(dest), static_cast<const void*>(std::addressof(*first)),
+			     static_cast<std::size_t>(std::distance(first, last)) * sizeof(value_type));
+	    }
+	}
+	else {
+	    std::uninitialized_copy(first, last, dest);
+	}
+    }
+
+    static void construct_fill(pointer dest, size_type count, const value_type& value) {
+	std::uninitialized_fill_n(dest, count, value);
+    }
+
+    void set_size(size_type count) noexcept {
+	this->m_size = static_cast<decltype(this->m_size)>(count);
+    }
+
+    /// @brief Relocates the elements in `[index, size())` `n` positions towards the end,
+    /// see small_vector_base::open_gap().
+    size_type open_gap(size_type index, size_type n) {
+	const size_type tail = size() - index;
+	std::allocator<value_type> alloc;
+
+	set_size(index);
+	detail::open_gap(alloc, data() + index, tail, n);
+
+	return tail;
+    }
+
+    /// @brief Undoes static_vector::open_gap() after filling the gap failed.
+    void close_gap(size_type index, size_type n, size_type tail) noexcept {
+	std::allocator<value_type> alloc;
+	set_size(index + detail::close_gap(alloc, data() + index, tail, n));
+    }
+
+    template <typename Construct>
+    void resize_with(size_type count, Construct construct) {
+	if (count < size()) {
+	    erase(begin() + count, end());
+	}
+	else if (count > size()) {
+	    reserve(count);
+
+	    for (pointer current = end(); current != data() + count; ++current) {
+		construct(current);
+		++this->m_size;
+	    }
+	}
+    }
+};
+
+template <typename T, std::size_t N, std::size_t M>
+bool operator==(const static_vector<T, N>& lhs, const static_vector<T, M>& rhs) {
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <typename T, std::size_t N, std::size_t M>
+bool operator!=(const static_vector<T, N>& lhs, const static_vector<T, M>& rhs) {
+    return !(lhs == rhs);
+}
+
+template <typename T, std::size_t N, std::size_t M>
+bool operator<(const static_vector<T, N>& lhs, const static_vector<T, M>& rhs) {
+    return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <typename T, std::size_t N, std::size_t M>
+bool operator<=(const static_vector<T, N>& lhs, const static_vector<T, M>& rhs) {
+    return !(rhs < lhs);
+}
+
+template <typename T, std::size_t N, std::size_t M>
+bool operator>(const static_vector<T, N>& lhs, const static_vector<T, M>& rhs) {
+    return rhs < lhs;
+}
+
+template <typename T, std::size_t N, std::size_t M>
+bool operator>=(const static_vector<T, N>& lhs, const static_vector<T, M>& rhs) {
+    return !(lhs < rhs);
+}
+
+} // namespace ul
@@ -0,0 +1,297 @@
+/// @file
+/// Defines the allocation statistics of ul::small_vector_base.
+///
+/// When `UMLAUT_ENABLE_STATS` is set to 1 every `vector` records where it was
+/// constructed and reports to that site how often it spilled from its inline buffer to
+/// the heap, how often it reallocated on the heap, the number of bytes relocated while
+/// growing and its size when it is destroyed. Copies are counted at the site of the
+/// `vector` they were copied from and a moved-to `vector` takes over the site of the one
+/// it was moved from. Containers built on a `vector`, such as ul::small_string, pass
+/// their own call site down to it.
+///
+/// @copyright Marcus Larsson 2018
+/// Distributed under the Boost Software License, Version 1.0.
+/// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "config.hpp"
+
+#include <cstddef>
+
+#if UMLAUT_ENABLE_STATS
+#include <atomic>
+#include <cstdio>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define UMLAUT_CALL_SITE_PARAM , ::ul::detail::call_site site = ::ul::detail::call_site::current()
+#define UMLAUT_CALL_SITE site
+#define UMLAUT_CALL_SITE_ARG , site
+#else
+#define UMLAUT_CALL_SITE_PARAM
+#define UMLAUT_CALL_SITE ::ul::detail::call_site{}
+#define UMLAUT_CALL_SITE_ARG
+#endif
+
+namespace ul {
+namespace detail {
+
+/// Source location, captured at the caller when used as a default argument.
+struct call_site {
+    const char* file = "";
+    unsigned line = 0;
+    const char* function = "";
+
+    static constexpr call_site current(const char* file = __builtin_FILE(),
+				       unsigned line = __builtin_LINE(),
+				       const char* function = __builtin_FUNCTION()) noexcept {
+	return call_site{file, line, function};
+    }
+};
+
+/// Disambiguator tag converted implicitly from `Tag`, capturing the call site of a
+/// constructor whose trailing parameter pack leaves no room for a defaulted one.
+template <typename Tag>
+struct call_site_tag {
+    constexpr call_site_tag(Tag UMLAUT_CALL_SITE_PARAM) noexcept
+	: site(UMLAUT_CALL_SITE) {}
+
+    call_site site;
+};
+
+} // namespace detail
+
+#if UMLAUT_ENABLE_STATS
+
+/// @brief Statistics of the vectors constructed at one site.
+struct small_vector_stats {
+    /// @brief Number of buckets in small_vector_stats::final_sizes.
+    static constexpr std::size_t size_buckets = std::numeric_limits<std::size_t>::digits + 1;
+
+    const char* file;
+    unsigned line;
+    const char* function;
+
+    /// @brief Number of vectors constructed.
+    std::size_t vectors;
+
+    /// @brief Number of times a `vector` moved from its inline buffer to the heap.
+    std::size_t spills;
+
+    /// @brief Number of times a `vector` on the heap moved to a new allocation.
+    std::size_t reallocations;
+
+    /// @brief Number of bytes of elements relocated by spills and reallocations.
+    ///
+    /// A reallocating allocator resizing an allocation in place adds nothing, one moving
+    /// it adds the size of the elements even if the move remapped pages instead.
+    std::size_t bytes_copied;
+
+    /// @brief Histogram of the sizes of the vectors when destroyed.
+    ///
+    /// Bucket `i` counts sizes in `[2^(i-1), 2^i)`, bucket 0 counts empty vectors.
+    std::size_t final_sizes[size_buckets];
+};
+
+namespace detail {
+
+struct stats_site {
+    explicit stats_site(const call_site& site) noexcept : site(site) {}
+
+    call_site site;
+    std::atomic<std::size_t> vectors{0};
+    std::atomic<std::size_t> spills{0};
+    std::atomic<std::size_t> reallocations{0};
+    std::atomic<std::size_t> bytes_copied{0};
+    std::atomic<std::size_t> final_sizes[small_vector_stats::size_buckets]{};
+};
+
+class stats_registry {
+ public:
+    static stats_registry& instance() {
+	static stats_registry registry;
+	return registry;
+    }
+
+    stats_registry(const stats_registry&) = delete;
+    stats_registry& operator=(const stats_registry&) = delete;
+
+    ~stats_registry() {
+	if (UMLAUT_STATS_DUMP_AT_EXIT) {
+	    dump(stderr);
+	}
+    }
+
+    stats_site* site(const call_site& site) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return &m_sites.try_emplace(std::make_pair(std::string(site.file), site.line), site).first->second;
+    }
+
+    std::vector<small_vector_stats> collect() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	std::vector<small_vector_stats> result;
+
+	for (const auto& [key, site] : m_sites) {
+	    small_vector_stats stats{site.site.file, site.site.line, site.site.function,
+				     site.vectors.load(std::memory_order_relaxed),
+				     site.spills.load(std::memory_order_relaxed),
+				     site.reallocations.load(std::memory_order_relaxed),
+				     site.bytes_copied.load(std::memory_order_relaxed), {}};
+
+	    for (std::size_t i = 0; i < small_vector_stats::size_buckets; ++i) {
+		stats.final_sizes[i] = site.final_sizes[i].load(std::memory_order_relaxed);
+	    }
+
+	    result.push_back(stats);
+	}
+
+	return result;
+    }
+
+    void reset() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	for (auto& [key, site] : m_sites) {
+	    site.vectors = 0;
+	    site.spills = 0;
+	    site.reallocations = 0;
+	    site.bytes_copied = 0;
+
+	    for (auto& bucket : site.final_sizes) {
+		bucket = 0;
+	    }
+	}
+    }
+
+    void dump(std::FILE* out) const {
+	const auto sites = collect();
+
+	if (sites.empty()) {
+	    return;
+	}
+
+	std::fprintf(out, "small_vector statistics\n");
+
+	for (const auto& stats : sites) {
+	    std::fprintf(out, "%s:%u (%s): vectors %zu, spills %zu, reallocations %zu, bytes copied %zu\n"
+			 "    final sizes:", stats.file, stats.line, stats.function, stats.vectors,
+			 stats.spills, stats.reallocations, stats.bytes_copied);
+
+	    for (std::size_t i = 0; i < small_vector_stats::size_buckets; ++i) {
+		if (stats.final_sizes[i] == 0) {
+		    continue;
+		}
+
+		if (i == 0) {
+		    std::fprintf(out, " 0: %zu", stats.final_sizes[i]);
+		}
+		else {
+		    std::fprintf(out, " [%zu, %zu]: %zu", std::size_t(1) << (i - 1),
+				 (std::size_t(1) << (i - 1)) * 2 - 1, stats.final_sizes[i]);
+		}
+	    }
+
+	    std::fprintf(out, "\n");
+	}
+    }
+
+ private:
+    stats_registry() = default;
+
+    mutable std::mutex m_mutex;
+    std::map<std::pair<std::string, unsigned>, stats_site> m_sites;
+};
+
+/// Statistics of a single `vector`, a base class of ul::small_vector_base.
+class stats_hook {
+ public:
+    static constexpr std::size_t size = sizeof(stats_site*);
+
+ protected:
+    void track(const call_site& site) {
+	m_site = stats_registry::instance().site(site);
+	m_site->vectors.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void track_copy(const stats_hook& other) noexcept {
+	m_site = other.m_site;
+
+	if (m_site != nullptr) {
+	    m_site->vectors.fetch_add(1, std::memory_order_relaxed);
+	}
+    }
+
+    void track_move(stats_hook& other) noexcept {
+	if (m_site == nullptr) {
+	    m_site = other.m_site;
+	}
+
+	other.m_site = nullptr;
+    }
+
+    void record_growth(bool spill, std::size_t bytes) noexcept {
+	if (m_site != nullptr) {
+	    (spill ? m_site->spills : m_site->reallocations).fetch_add(1, std::memory_order_relaxed);
+	    m_site->bytes_copied.fetch_add(bytes, std::memory_order_relaxed);
+	}
+    }
+
+    void record_destruction(std::size_t size) noexcept {
+	if (m_site != nullptr) {
+	    std::size_t bucket = 0;
+
+	    for (; size != 0; size >>= 1) {
+		++bucket;
+	    }
+
+	    m_site->final_sizes[bucket].fetch_add(1, std::memory_order_relaxed);
+	}
+    }
+
+ private:
+    stats_site* m_site = nullptr;
+};
+
+} // namespace detail
+
+/// @brief Returns the statistics of all construction sites recorded so far.
+inline std::vector<small_vector_stats> collect_small_vector_stats() {
+    return detail::stats_registry::instance().collect();
+}
+
+/// @brief Prints the statistics of all construction sites to `out`.
+inline void dump_small_vector_stats(std::FILE* out = stderr) {
+    detail::stats_registry::instance().dump(out);
+}
+
+/// @brief Resets all counters to zero.
+inline void reset_small_vector_stats() {
+    detail::stats_registry::instance().reset();
+}
+
+#else
+
+namespace detail {
+
+class stats_hook {
+ public:
+    static constexpr std::size_t size = 0;
+
+ protected:
+    void track(const call_site&) noexcept {}
+    void track_copy(const stats_hook&) noexcept {}
+    void track_move(stats_hook&) noexcept {}
+    void record_growth(bool, std::size_t) noexcept {}
+    void record_destruction(std::size_t) noexcept {}
+};
+
+} // namespace detail
+
+#endif // UMLAUT_ENABLE_STATS
+
+} // namespace ul
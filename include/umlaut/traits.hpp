@@ -10,6 +10,7 @@
 #include "config.hpp"
 
 #include <type_traits>
+#include <memory>
 #include <cstddef>
 
 #if UMLAUT_HAS_BUILTIN(__type_pack_element)
@@ -65,6 +66,16 @@ template <typename T>
 using remove_cvref_t = typename remove_cvref<T>::type;
 
 
+/// @brief Traits class wrapping `T` unchanged, used to exclude a parameter from template
+/// argument deduction.
+template <typename T>
+struct type_identity { using type = T; };
+
+/// @relates type_identity
+template <typename T>
+using type_identity_t = typename type_identity<T>::type;
+
+
 /// @brief Traits class used to determine if an iterator is contigous or not.
 template <typename T>
 struct is_contiguous_iterator : std::is_pointer<T> {};
@@ -102,4 +113,9 @@ struct is_trivially_relocatable : decltype(detail::itr_helper<T>(priority_tag<1>
 template <typename T>
 inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
 
+/// @brief `std::unique_ptr` with the default deleter is only a pointer and can be relocated
+/// with `memcpy` even though its move constructor and destructor are non-trivial.
+template <typename T>
+struct is_trivially_relocatable<std::unique_ptr<T, std::default_delete<T>>> : std::true_type {};
+
 } // namespace ul
@@ -0,0 +1,103 @@
+// Copyright Marcus Larsson 2018
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include <catch2/catch.hpp>
+#include <umlaut/algorithm.hpp>
+#include <umlaut/small_vector.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <list>
+#include <vector>
+
+namespace {
+
+enum class color : std::uint16_t { red, green, blue };
+
+template <typename T>
+void check_against_std() {
+    // Covers sizes below, at and above the register widths and every match position.
+    for (int size = 0; size < 70; ++size) {
+	ul::small_vector<T, 8> v;
+
+	for (int i = 0; i < size; ++i) {
+	    v.push_back(static_cast<T>(i % 5 + 1));
+	}
+
+	for (int i = 0; i <= 6; ++i) {
+	    const T value = static_cast<T>(i);
+
+	    REQUIRE(ul::find(v, value) == std::find(v.begin(), v.end(), value));
+	    REQUIRE(ul::count(v, value) == std::count(v.begin(), v.end(), value));
+	    REQUIRE(ul::contains(v, value) == (std::find(v.begin(), v.end(), value) != v.end()));
+	}
+
+	for (int i = 0; i < size; ++i) {
+	    const T value = static_cast<T>(100);
+	    v[i] = value;
+
+	    REQUIRE(ul::find(v, value) == v.begin() + i);
+	    REQUIRE(ul::count(v, value) == 1);
+
+	    v[i] = static_cast<T>(1);
+	}
+    }
+}
+
+} // namespace
+
+TEST_CASE("find, count and contains agree with the standard algorithms", "[algorithm]") {
+    check_against_std<char>();
+    check_against_std<std::int8_t>();
+    check_against_std<std::uint16_t>();
+    check_against_std<int>();
+    check_against_std<std::int64_t>();
+    check_against_std<std::uint64_t>();
+    check_against_std<float>();
+    check_against_std<double>();
+}
+
+TEST_CASE("find, count and contains of special values", "[algorithm]") {
+    SECTION("enumerations") {
+	ul::small_vector<color, 4> v(ul::list_construct, color::red, color::green, color::green);
+
+	CHECK(ul::find(v, color::green) == v.begin() + 1);
+	CHECK(ul::count(v, color::green) == 2);
+	CHECK_FALSE(ul::contains(v, color::blue));
+    }
+
+    SECTION("floating point compares like ==") {
+	const double nan = std::numeric_limits<double>::quiet_NaN();
+	std::vector<double> v(40, 1.0);
+	v[20] = -0.0;
+	v[30] = nan;
+
+	CHECK(ul::find(v.data(), v.data() + v.size(), 0.0) == v.data() + 20);
+	CHECK(ul::count(v.data(), v.data() + v.size(), nan) == 0);
+	CHECK_FALSE(ul::contains(v.data(), v.data() + v.size(), nan));
+    }
+
+    SECTION("values of a different type") {
+	ul::small_vector<std::uint8_t, 40> bytes(ul::list_construct, 0, 1, 2, 255);
+	bytes.resize(40);
+	ul::small_vector<unsigned, 4> numbers(ul::list_construct, 1u, 4294967295u);
+	ul::small_vector<float, 4> floats(ul::list_construct, 0.5f, 1.5f);
+
+	CHECK(ul::count(bytes, 0) == 37);
+	CHECK_FALSE(ul::contains(bytes, 256));
+	CHECK_FALSE(ul::contains(bytes, -1));
+	CHECK(ul::find(bytes, 255) == bytes.begin() + 3);
+	CHECK(ul::find(numbers, -1) == numbers.begin() + 1);
+	CHECK(ul::contains(floats, 1.5));
+	CHECK_FALSE(ul::contains(floats, 1.1));
+    }
+
+    SECTION("non contiguous ranges") {
+	const std::list<int> l = {1, 2, 3, 2};
+
+	CHECK(ul::find(l, 3) == std::next(l.begin(), 2));
+	CHECK(ul::count(l, 2) == 2);
+	CHECK(ul::contains(l, 1));
+    }
+}
@@ -0,0 +1,156 @@
+// Copyright Marcus Larsson 2018
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include <catch2/catch.hpp>
+#include <umlaut/allocator.hpp>
+#include <umlaut/small_vector.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+TEST_CASE("default_init_allocator", "[allocator]") {
+    using alloc = ul::default_init_allocator<int>;
+    using traits = std::allocator_traits<alloc>;
+
+    SECTION("is empty and rebinds to itself") {
+	CHECK(std::is_empty_v<alloc>);
+	CHECK(std::is_same_v<traits::rebind_alloc<double>, ul::default_init_allocator<double>>);
+    }
+
+    SECTION("construction with arguments is forwarded") {
+	ul::default_init_allocator<std::string> string_alloc;
+	std::string* ptr = string_alloc.allocate(1);
+
+	std::allocator_traits<decltype(string_alloc)>::construct(string_alloc, ptr, 3, 'a');
+	CHECK(*ptr == "aaa");
+
+	std::allocator_traits<decltype(string_alloc)>::destroy(string_alloc, ptr);
+	string_alloc.deallocate(ptr, 1);
+    }
+
+    SECTION("resize of a small_vector does not zero fill") {
+	ul::small_vector<int, 8, alloc> v(ul::list_construct, 1, 2, 3, 4);
+	v.clear();
+	v.resize(4);
+
+	REQUIRE(v.size() == 4);
+	CHECK(v[0] == 1);
+	CHECK(v[3] == 4);
+    }
+}
+
+namespace {
+
+template <typename T>
+struct counting_reallocator : ul::reallocating_allocator<T> {
+    counting_reallocator(int& reallocations) : reallocations(&reallocations) {}
+
+    template <typename U>
+    counting_reallocator(const counting_reallocator<U>& other) : reallocations(other.reallocations) {}
+
+    T* reallocate(T* ptr, std::size_t old_n, std::size_t new_n) {
+	++*reallocations;
+	return ul::reallocating_allocator<T>::reallocate(ptr, old_n, new_n);
+    }
+
+    int* reallocations;
+};
+
+} // namespace
+
+TEST_CASE("reallocating_allocator", "[allocator]") {
+    CHECK(ul::is_reallocating_allocator_v<ul::reallocating_allocator<int>>);
+    CHECK(ul::is_reallocating_allocator_v<ul::default_init_allocator<int, ul::reallocating_allocator<int>>>);
+    CHECK_FALSE(ul::is_reallocating_allocator_v<std::allocator<int>>);
+
+    SECTION("reallocate keeps the contents across the mapping threshold") {
+	ul::reallocating_allocator<int> alloc;
+	const std::size_t large = UMLAUT_MREMAP_THRESHOLD / sizeof(int) * 3;
+
+	int* ptr = alloc.allocate(4);
+	for (int i = 0; i < 4; ++i) ptr[i] = i;
+
+	ptr = alloc.reallocate(ptr, 4, large);
+	ptr[large - 1] = 42;
+	ptr = alloc.reallocate(ptr, large, large * 2);
+
+	for (int i = 0; i < 4; ++i) CHECK(ptr[i] == i);
+	CHECK(ptr[large - 1] == 42);
+
+	ptr = alloc.reallocate(ptr, large * 2, 2);
+	CHECK(ptr[1] == 1);
+
+	alloc.deallocate(ptr, 2);
+    }
+
+    SECTION("small_vector grows trivially relocatable elements in place") {
+	int reallocations = 0;
+	ul::small_vector<int, 4, counting_reallocator<int>> v{counting_reallocator<int>(reallocations)};
+
+	for (int i = 0; i < 1000000; ++i) v.push_back(i);
+
+	CHECK(reallocations > 0);
+	for (int i = 0; i < 1000000; i += 997) REQUIRE(v[i] == i);
+
+	v.resize(3);
+	v.shrink_to_fit();
+	CHECK(v.is_inline());
+	CHECK(v[2] == 2);
+    }
+
+    SECTION("elements of the vector itself can be appended when growing") {
+	ul::small_vector<std::unique_ptr<int>, 1, ul::reallocating_allocator<std::unique_ptr<int>>> p;
+	ul::small_vector<std::string, 1, ul::reallocating_allocator<std::string>> s(ul::list_construct, "a");
+	ul::small_vector<int, 1, ul::reallocating_allocator<int>> v(ul::list_construct, 1, 2);
+
+	while (v.size() < v.capacity()) v.push_back(3);
+	v.push_back(v[0]);
+	v.insert(v.begin(), v[v.size() - 1]);
+
+	CHECK(v[0] == 1);
+	CHECK(v[v.size() - 1] == 1);
+
+	for (int i = 0; i < 10; ++i) p.push_back(std::make_unique<int>(i));
+	for (int i = 0; i < 10; ++i) s.push_back(s[0]);
+
+	CHECK(*p[9] == 9);
+	CHECK(s[10] == "a");
+    }
+}
+
+TEST_CASE("huge_page_allocator", "[allocator]") {
+    using alloc = ul::huge_page_allocator<std::uint64_t>;
+    constexpr std::size_t large = UMLAUT_HUGE_PAGE_THRESHOLD / sizeof(std::uint64_t) + 1;
+
+    CHECK(std::is_empty_v<alloc>);
+
+    SECTION("large allocations are aligned to a huge page") {
+	alloc a;
+	std::uint64_t* ptr = a.allocate(large);
+
+#if defined(__linux__)
+	CHECK(reinterpret_cast<std::uintptr_t>(ptr) % alloc::huge_page_size == 0);
+#endif
+
+	ptr[0] = 1;
+	ptr[large - 1] = 2;
+	CHECK(ptr[0] + ptr[large - 1] == 3);
+
+	a.deallocate(ptr, large);
+    }
+
+    SECTION("small_vector spills into huge pages") {
+	ul::small_vector<std::uint64_t, 4, alloc> v;
+
+	for (std::uint64_t i = 0; i < large; ++i) v.push_back(i);
+
+	CHECK(v.size() == large);
+	for (std::size_t i = 0; i < large; i += 1001) REQUIRE(v[i] == i);
+
+	v.resize(4);
+	v.shrink_to_fit();
+	CHECK(v.is_inline());
+    }
+}
@@ -0,0 +1,133 @@
+// Copyright Marcus Larsson 2018
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include <catch2/catch.hpp>
+#include <umlaut/arena.hpp>
+#include <umlaut/small_vector.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+TEST_CASE("allocation from monotonic_arena", "[arena]") {
+    ul::monotonic_arena arena(64);
+
+    SECTION("allocations are aligned and distinct") {
+	auto a = static_cast<char*>(arena.allocate(3, 1));
+	auto b = static_cast<double*>(arena.allocate(sizeof(double), alignof(double)));
+
+	CHECK(reinterpret_cast<std::uintptr_t>(b) % alignof(double) == 0);
+	CHECK(static_cast<void*>(a + 3) <= static_cast<void*>(b));
+    }
+
+    SECTION("grows with new blocks") {
+	for (int i = 0; i < 100; ++i) arena.allocate(16);
+
+	CHECK(arena.capacity() >= 1600);
+
+	auto large = arena.allocate(10000);
+	CHECK(large != nullptr);
+    }
+
+    SECTION("rewind to a marker") {
+	arena.allocate(8);
+	auto marker = arena.mark();
+	auto first = arena.allocate(8);
+
+	for (int i = 0; i < 100; ++i) arena.allocate(16);
+	arena.release(marker);
+
+	CHECK(arena.allocate(8) == first);
+    }
+
+    SECTION("padding past the end of a block adds a new block") {
+	ul::monotonic_arena small(100);
+	auto a = static_cast<std::byte*>(small.allocate(99, 1));
+	auto b = static_cast<std::byte*>(small.allocate(8, 8));
+
+	CHECK(reinterpret_cast<std::uintptr_t>(b) % 8 == 0);
+	CHECK((b + 8 <= a || b >= a + 99));
+	CHECK(small.capacity() > 100);
+    }
+
+    SECTION("rewind to a marker whose block was released") {
+	auto marker = arena.mark();
+	arena.allocate(8);
+	auto second = arena.mark();
+
+	for (int i = 0; i < 100; ++i) arena.allocate(16);
+	arena.release();
+	arena.release(second);
+
+	CHECK(arena.capacity() > 0);
+	CHECK(arena.allocate(8) != nullptr);
+
+	arena.release(marker);
+	CHECK(arena.allocate(8) != nullptr);
+    }
+
+    SECTION("release keeps the newest block") {
+	for (int i = 0; i < 100; ++i) arena.allocate(16);
+	arena.release();
+
+	const auto capacity = arena.capacity();
+	for (int i = 0; i < 10; ++i) arena.allocate(16);
+
+	CHECK(arena.capacity() == capacity);
+    }
+
+    SECTION("deallocate reclaims the most recent allocation") {
+	auto a = arena.allocate(8);
+	arena.deallocate(a, 8);
+
+	CHECK(arena.allocate(8) == a);
+    }
+}
+
+TEST_CASE("small_vector with arena_allocator", "[arena][small_vector]") {
+    ul::monotonic_arena arena;
+    ul::arena_allocator<std::string> alloc(arena);
+
+    CHECK(sizeof(alloc) == sizeof(void*));
+
+    ul::small_vector<std::string, 2, ul::arena_allocator<std::string>> v(ul::list_construct, alloc, "a", "b");
+
+    for (int i = 0; i < 100; ++i) v.push_back(std::to_string(i));
+
+    CHECK_FALSE(v.is_inline());
+    CHECK(v.get_allocator() == alloc);
+    REQUIRE(v.size() == 102);
+    CHECK(v[0] == "a");
+    CHECK(v[101] == "99");
+
+    ul::monotonic_arena other_arena;
+    ul::small_vector<std::string, 2, ul::arena_allocator<std::string>> w(other_arena);
+    w = std::move(v);
+
+    CHECK(w.get_allocator().arena() == &other_arena);
+    CHECK(w.size() == 102);
+    CHECK(w[101] == "99");
+}
+
+TEST_CASE("small_vector_base placed in the arena it allocates from", "[arena][small_vector]") {
+    using vector = ul::small_vector_base<int, ul::arena_allocator<int>>;
+
+    ul::monotonic_arena arena;
+    auto v = ::new (arena.allocate(sizeof(vector), alignof(vector))) vector(ul::arena_allocator<int>(arena));
+
+    CHECK(v->is_inline());
+
+    v->push_back(1);
+
+    // the allocation directly follows the vector, where an inline buffer would be
+    CHECK_FALSE(v->is_inline());
+    CHECK((*v)[0] == 1);
+
+    for (int i = 2; i <= 10; ++i) v->push_back(i);
+    v->shrink_to_fit();
+
+    CHECK_FALSE(v->is_inline());
+    CHECK((*v)[9] == 10);
+
+    v->~vector();
+}
@@ -4,6 +4,7 @@
 
 #include <catch2/catch.hpp>
 #include <umlaut/compressed_pair.hpp>
+#include <memory>
 #include <type_traits>
 #include <utility>
 #include <string>
@@ -41,3 +42,15 @@ TEST_CASE("empty base optimization of compressed_pair", "[compressed_pair][ebo]"
     CHECK(sizeof(largest) > sizeof(middle));
     CHECK(sizeof(middle) > sizeof(smallest));
 }
+
+TEST_CASE("trivial relocatability of compressed_pair", "[compressed_pair]") {
+    struct self_referencing {
+	self_referencing() : self(this) {}
+	self_referencing(const self_referencing&) : self(this) {}
+	self_referencing* self;
+    };
+
+    CHECK(ul::is_trivially_relocatable_v<ul::compressed_pair<int, empty_cat>>);
+    CHECK(ul::is_trivially_relocatable_v<ul::compressed_pair<std::unique_ptr<int>, empty_cat>>);
+    CHECK_FALSE(ul::is_trivially_relocatable_v<ul::compressed_pair<std::unique_ptr<int>, self_referencing>>);
+}
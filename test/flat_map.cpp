@@ -0,0 +1,155 @@
+// Copyright Marcus Larsson 2018
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include <catch2/catch.hpp>
+#include <umlaut/flat_map.hpp>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+TEST_CASE("lookup in flat_set", "[flat_map]") {
+    SECTION("lower_bound agrees with std::lower_bound") {
+	for (int size = 0; size < 40; ++size) {
+	    std::vector<int> keys;
+	    for (int i = 0; i < size; ++i) keys.push_back(i * 2);
+
+	    ul::flat_set<int, 8> set(ul::sorted_unique, keys.begin(), keys.end());
+
+	    for (int key = -1; key <= size * 2; ++key) {
+		const auto expected = std::lower_bound(keys.begin(), keys.end(), key) - keys.begin();
+
+		REQUIRE(set.lower_bound(key) - set.begin() == expected);
+		REQUIRE(set.contains(key) == (key >= 0 && key < size * 2 && key % 2 == 0));
+	    }
+	}
+    }
+
+    SECTION("upper_bound, find and count") {
+	const int keys[] = {1, 3, 5};
+	ul::flat_set<int, 4> set(ul::sorted_unique, std::begin(keys), std::end(keys));
+
+	CHECK(set.upper_bound(3) - set.begin() == 2);
+	CHECK(set.upper_bound(4) - set.begin() == 2);
+	CHECK(set.find(5) == set.begin() + 2);
+	CHECK(set.find(4) == set.end());
+	CHECK(set.count(1) == 1);
+	CHECK(set.count(2) == 0);
+    }
+
+    SECTION("transparent comparison") {
+	ul::flat_set<std::string, 4, std::less<>> set;
+	set.insert("b");
+	set.insert("a");
+
+	CHECK(set.contains(std::string_view("a")));
+	CHECK(set.find(std::string_view("b")) == set.begin() + 1);
+	CHECK_FALSE(set.contains(std::string_view("c")));
+    }
+}
+
+TEST_CASE("modifiers of flat_set", "[flat_map]") {
+    ul::flat_set<int, 4> set;
+
+    CHECK(set.capacity() == 4);
+
+    SECTION("single insertions keep the keys sorted and unique") {
+	CHECK(set.insert(3).second);
+	CHECK(set.insert(1).second);
+	CHECK(set.emplace(2).second);
+	CHECK_FALSE(set.insert(3).second);
+
+	REQUIRE(set.size() == 3);
+	CHECK(std::is_sorted(set.begin(), set.end()));
+	CHECK(set.capacity() == 4);
+    }
+
+    SECTION("bulk insertion merges and removes duplicates") {
+	const std::vector<int> first = {9, 1, 5, 1, 7};
+	const std::vector<int> second = {2, 5, 8, 9, 10};
+
+	set.insert(first.begin(), first.end());
+	set.insert(ul::sorted_unique, second.begin(), second.end());
+
+	const std::vector<int> expected = {1, 2, 5, 7, 8, 9, 10};
+	CHECK(std::equal(set.begin(), set.end(), expected.begin(), expected.end()));
+    }
+
+    SECTION("construction from an unsorted range") {
+	const std::vector<int> keys = {4, 2, 4, 3};
+	ul::flat_set<int, 4> other(keys.begin(), keys.end());
+
+	REQUIRE(other.size() == 3);
+	CHECK(other.begin()[0] == 2);
+	CHECK(other.begin()[2] == 4);
+    }
+
+    SECTION("erase") {
+	const std::vector<int> keys = {1, 2, 3, 4};
+	set.insert(keys.begin(), keys.end());
+
+	CHECK(set.erase(2) == 1);
+	CHECK(set.erase(2) == 0);
+	set.erase(set.begin());
+
+	REQUIRE(set.size() == 2);
+	CHECK(set.begin()[0] == 3);
+    }
+}
+
+TEST_CASE("flat_map", "[flat_map]") {
+    ul::flat_map<std::string, int, 4> map;
+
+    SECTION("operator[] and at") {
+	map["b"] = 2;
+	map["a"] = 1;
+	++map["b"];
+
+	REQUIRE(map.size() == 2);
+	CHECK(map.begin()->first == "a");
+	CHECK(map.at("b") == 3);
+	CHECK_THROWS_AS(map.at("c"), std::out_of_range);
+    }
+
+    SECTION("try_emplace and insert_or_assign") {
+	CHECK(map.try_emplace("a", 1).second);
+	CHECK_FALSE(map.try_emplace("a", 2).second);
+	CHECK(map.at("a") == 1);
+
+	CHECK_FALSE(map.insert_or_assign("a", 3).second);
+	CHECK(map.insert_or_assign("b", 4).second);
+	CHECK(map.at("a") == 3);
+	CHECK(map.at("b") == 4);
+    }
+
+    SECTION("bulk insertion keeps existing values") {
+	map.emplace("b", 1);
+
+	const std::vector<std::pair<std::string, int>> pairs = {{"c", 3}, {"b", 2}, {"a", 1}};
+	map.insert(pairs.begin(), pairs.end());
+
+	REQUIRE(map.size() == 3);
+	CHECK(map.at("a") == 1);
+	CHECK(map.at("b") == 1);
+	CHECK(map.at("c") == 3);
+	CHECK(map.capacity() == 4);
+    }
+
+    SECTION("spills to the heap and compares by value") {
+	for (int i = 0; i < 100; ++i) map[std::to_string(i)] = i;
+
+	auto copy = map;
+
+	CHECK(copy == map);
+	CHECK(copy.size() == 100);
+	CHECK(copy.at("42") == 42);
+
+	copy["42"] = 0;
+	CHECK(copy != map);
+    }
+}
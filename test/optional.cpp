@@ -4,6 +4,10 @@
 
 #include <catch2/catch.hpp>
 #include <umlaut/optional.hpp>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
 #include <type_traits>
 #include <string>
 
@@ -293,3 +297,341 @@ TEST_CASE("assignment of optional", "[optional]") {
 	CHECK_FALSE(opt.has_value());
     }
 }
+
+namespace {
+
+enum class color : unsigned char { red, green, blue };
+
+struct handle {
+    int id;
+};
+
+struct node {
+    int value;
+};
+
+struct meters {
+    double value;
+};
+
+} // namespace
+
+template <>
+struct ul::optional_traits<node*> : ul::optional_pointer_traits<node> {};
+
+template <>
+struct ul::optional_traits<meters> : ul::optional_nan_traits<meters> {};
+
+template <>
+struct ul::optional_traits<color> : ul::optional_sentinel_traits<color, color{0xff}> {};
+
+template <>
+struct ul::optional_traits<handle> {
+    static constexpr bool has_sentinel = true;
+
+    static constexpr handle empty_value() noexcept { return handle{-1}; }
+    static constexpr bool is_empty(const handle& value) noexcept { return value.id == -1; }
+};
+
+TEST_CASE("sentinel storage of optional", "[optional]") {
+    SECTION("no engaged flag is stored") {
+	CHECK(sizeof(ul::optional<node*>) == sizeof(node*));
+	CHECK(sizeof(ul::optional<meters>) == sizeof(meters));
+	CHECK(sizeof(ul::optional<color>) == sizeof(color));
+	CHECK(sizeof(ul::optional<handle>) == sizeof(handle));
+	CHECK(sizeof(ul::optional<int>) == 2 * sizeof(int));
+    }
+
+    SECTION("built-in types keep their engaged flag") {
+	constexpr ul::optional<double> number{1.5};
+	constexpr ul::optional<int*> pointer;
+	static_assert(number.has_value() && !pointer.has_value());
+
+	CHECK(sizeof(ul::optional<int*>) == 2 * sizeof(int*));
+	CHECK(sizeof(ul::optional<double>) == 2 * sizeof(double));
+
+	ul::optional<int*> all_ones{reinterpret_cast<int*>(~std::uintptr_t{0})};
+	CHECK(all_ones.has_value());
+    }
+
+    SECTION("pointers") {
+	node value{0};
+	ul::optional<node*> opt;
+
+	CHECK_FALSE(opt.has_value());
+
+	opt = &value;
+	CHECK(opt.has_value());
+	CHECK(*opt == &value);
+
+	opt = nullptr;
+	CHECK(opt.has_value());
+	CHECK(*opt == nullptr);
+
+	opt.reset();
+	CHECK_FALSE(opt.has_value());
+    }
+
+    SECTION("NaN sentinels can still hold other NaNs") {
+	ul::optional<meters> opt{ul::nullopt};
+
+	CHECK_FALSE(opt.has_value());
+	CHECK(opt.value_or(meters{1.5}).value == 1.5);
+
+	opt = meters{std::numeric_limits<double>::quiet_NaN()};
+	CHECK(opt.has_value());
+	CHECK(std::isnan(opt->value));
+
+	opt = ul::nullopt;
+	CHECK_FALSE(opt);
+    }
+
+    SECTION("enums and user types") {
+	constexpr ul::optional<color> constant{color::blue};
+	static_assert(constant.has_value());
+
+	ul::optional<color> opt;
+	CHECK_FALSE(opt.has_value());
+
+	opt.emplace(color::green);
+	CHECK(opt.value() == color::green);
+
+	ul::optional<handle> h{handle{3}};
+	ul::optional<handle> empty;
+
+	h.swap(empty);
+	CHECK_FALSE(h.has_value());
+	CHECK(empty->id == 3);
+	CHECK(h.then([](handle x) { return x.id; }).value_or(0) == 0);
+	CHECK(empty.then([](handle x) { return x.id; }).value_or(0) == 3);
+    }
+}
+
+TEST_CASE("optional references", "[optional]") {
+    struct record {
+	int id;
+	std::string name;
+    };
+
+    record records[] = {{1, "one"}, {2, "two"}};
+
+    auto lookup = [&](int id) -> ul::optional<record&> {
+	for (auto& r : records) {
+	    if (r.id == id) return r;
+	}
+
+	return ul::nullopt;
+    };
+
+    SECTION("is a single pointer") {
+	CHECK(sizeof(ul::optional<record&>) == sizeof(record*));
+	CHECK(std::is_trivially_copyable_v<ul::optional<record&>>);
+	CHECK_FALSE(std::is_constructible_v<ul::optional<const int&>, int&&>);
+    }
+
+    SECTION("refers to the value without copying it") {
+	auto found = lookup(2);
+
+	REQUIRE(found.has_value());
+	CHECK(&*found == &records[1]);
+
+	found->name = "deux";
+	CHECK(records[1].name == "deux");
+
+	CHECK_FALSE(lookup(3));
+	CHECK_THROWS_AS(lookup(3).value(), ul::bad_optional_access);
+    }
+
+    SECTION("assignment rebinds") {
+	int a = 1;
+	int b = 2;
+	ul::optional<int&> opt = a;
+
+	opt = b;
+	*opt = 3;
+
+	CHECK(a == 1);
+	CHECK(b == 3);
+
+	ul::optional<const int&> view = opt;
+	CHECK(&*view == &b);
+
+	opt.reset();
+	CHECK_FALSE(opt.has_value());
+	CHECK(opt.value_or(7) == 7);
+    }
+
+    SECTION("monadic interface") {
+	auto name = lookup(1).then([](record& r) -> std::string& { return r.name; });
+
+	CHECK(std::is_same_v<decltype(name), ul::optional<std::string&>>);
+	CHECK(&*name == &records[0].name);
+
+	auto length = lookup(3).then([](record& r) { return r.name.size(); });
+	CHECK_FALSE(length.has_value());
+
+	auto fallback = lookup(3).catch_error([&]() { return lookup(1); });
+	CHECK(&*fallback == &records[0]);
+    }
+}
+
+TEST_CASE("trivial relocatability of optional", "[optional]") {
+    struct self_referencing {
+	self_referencing() : self(this) {}
+	self_referencing(const self_referencing&) : self(this) {}
+	self_referencing* self;
+    };
+
+    CHECK(ul::is_trivially_relocatable_v<ul::optional<int>>);
+    CHECK(ul::is_trivially_relocatable_v<ul::optional<std::unique_ptr<int>>>);
+    CHECK(ul::is_trivially_relocatable_v<ul::optional<std::unique_ptr<int>&>>);
+    CHECK_FALSE(ul::is_trivially_relocatable_v<ul::optional<self_referencing>>);
+}
+
+namespace {
+
+struct counted {
+    static inline int moves = 0;
+
+    explicit counted(int value) : value(value) {}
+    counted(const counted& other) : value(other.value) { ++moves; }
+    counted(counted&& other) noexcept : value(other.value) { ++moves; }
+
+    int value;
+};
+
+} // namespace
+
+TEST_CASE("pipelines of optional", "[optional][monads]") {
+    ul::optional opt{1};
+
+    SECTION("same results as chaining members") {
+	ul::optional<int> result = opt
+	  | ul::then([](int value) { return ul::optional<int>(value + 5); })
+	  | ul::then([](int value) { return value + 1; })
+	  | ul::then(&add_three);
+
+	CHECK(result.has_value());
+	CHECK(*result == 10);
+	CHECK((opt | ul::then([](int value) { return value * 2; }) | ul::value_or(0)) == 2);
+    }
+
+    SECTION("stages after a failed stage are skipped") {
+	bool post_fail_invoked = false;
+
+	ul::optional<int> result = opt
+	  | ul::then([](int) { return ul::optional<int>(); })
+	  | ul::then([&](int value) { post_fail_invoked = true; return value; });
+
+	CHECK_FALSE(post_fail_invoked);
+	CHECK_FALSE(result.has_value());
+    }
+
+    SECTION("catch_error recovers and the pipeline continues") {
+	bool catch_invoked = false;
+
+	const int value = ul::optional<int>()
+	  | ul::catch_error([&]() { catch_invoked = true; })
+	  | ul::catch_error([]() { return ul::optional<int>(4); })
+	  | ul::then([](int value) { return value + 1; })
+	  | ul::value_or(0);
+
+	CHECK(catch_invoked);
+	CHECK(value == 5);
+	CHECK((opt | ul::catch_error([]() { return 7; }) | ul::value_or(0)) == 1);
+    }
+
+    SECTION("evaluation is lazy") {
+	int invocations = 0;
+	auto pipeline = opt | ul::then([&](int value) { ++invocations; return value + 1; });
+
+	CHECK(invocations == 0);
+
+	opt = 10;
+	CHECK(*static_cast<ul::optional<int>>(pipeline) == 11);
+	CHECK(invocations == 1);
+    }
+
+    SECTION("stages composed before they are applied") {
+	auto validate = ul::then([](const std::string& s) -> ul::optional<std::string> {
+	    if (s.empty()) return ul::nullopt;
+	    return s + "!";
+	}) | ul::then([](const std::string& s) { return s.size(); });
+
+	CHECK((ul::optional<std::string>("abc") | validate | ul::value_or(0u)) == 4u);
+	CHECK((ul::optional<std::string>("") | validate | ul::value_or(0u)) == 0u);
+	CHECK((ul::optional<std::string>() | validate | ul::value_or(0u)) == 0u);
+    }
+
+    SECTION("intermediate values are not moved") {
+	const auto next = [](const counted& c) { return counted(c.value + 1); };
+	ul::optional<counted> source{std::in_place, 0};
+
+	counted::moves = 0;
+	auto members = source.then(next).then(next).then(next).then(next);
+	CHECK(members->value == 4);
+	CHECK(counted::moves == 4);
+
+	counted::moves = 0;
+	ul::optional<counted> fused = source
+	  | ul::then(next) | ul::then(next) | ul::then(next) | ul::then(next);
+	CHECK(fused->value == 4);
+	CHECK(counted::moves == 1);
+
+	counted::moves = 0;
+	counted value = source | ul::then(next) | ul::then(next) | ul::value_or(-1);
+	CHECK(value.value == 2);
+	CHECK(counted::moves == 1);
+    }
+
+    SECTION("rvalue sources with rvalue-only and move-only stages") {
+	const auto make = []() { return ul::optional<std::string>("abc"); };
+
+	CHECK((make() | ul::then([](std::string&& s) { return s.size(); }) | ul::value_or(0u)) == 3u);
+
+	ul::optional<std::unique_ptr<int>> pointer = ul::optional<std::unique_ptr<int>>(std::make_unique<int>(2))
+	  | ul::then([](std::unique_ptr<int> p) { *p *= 2; return p; })
+	  | ul::then([](std::unique_ptr<int>&& p) { return ul::optional<std::unique_ptr<int>>(std::move(p)); });
+
+	REQUIRE(pointer.has_value());
+	CHECK(**pointer == 4);
+
+	ul::optional<int> counter = opt | ul::then([n = 1](int value) mutable { return value + n++; });
+	CHECK(*counter == 2);
+    }
+
+    SECTION("an rvalue source is not moved by each stage") {
+	const auto next = [](counted&& c) { return counted(c.value + 1); };
+
+	counted::moves = 0;
+	ul::optional<counted> result = ul::optional<counted>(std::in_place, 0)
+	  | (ul::then(next) | ul::then(next) | ul::then(next) | ul::then(next));
+
+	CHECK(result->value == 4);
+	CHECK(counted::moves == 2);
+    }
+
+    SECTION("a pipeline owns an rvalue source") {
+	const auto make = []() { return ul::optional<std::string>(std::in_place, 40, 'x'); };
+
+	auto pipeline = make() | ul::then([](std::string&& s) { return s.size(); });
+
+	ul::optional<std::size_t> result = std::move(pipeline);
+	REQUIRE(result.has_value());
+	CHECK(*result == 40u);
+
+	auto empty = ul::optional<std::string>() | ul::then([](const std::string& s) { return s.size(); });
+	CHECK((std::move(empty) | ul::value_or(7u)) == 7u);
+    }
+
+    SECTION("references pass through") {
+	struct record { std::string name; };
+	record r{"name"};
+	ul::optional<record&> ref = r;
+
+	ul::optional<std::string&> name = ref | ul::then([](record& r) -> std::string& { return r.name; });
+
+	CHECK(&*name == &r.name);
+	CHECK((ref | ul::then([](record& r) { return r.name.size(); }) | ul::value_or(0u)) == 4u);
+    }
+}
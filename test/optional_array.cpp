@@ -0,0 +1,185 @@
+// Copyright Marcus Larsson 2018
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include <catch2/catch.hpp>
+#include <umlaut/optional_array.hpp>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Element `i` is engaged unless it is divisible by 3, with the value `i`.
+template <typename T>
+ul::optional_array<T> make_column(std::size_t size) {
+    ul::optional_array<T> column;
+
+    for (std::size_t i = 0; i < size; ++i) {
+	if (i % 3 == 0) column.push_back(ul::nullopt);
+	else column.push_back(static_cast<T>(i));
+    }
+
+    return column;
+}
+
+} // namespace
+
+TEST_CASE("element access of optional_array", "[optional_array]") {
+    ul::optional_array<int> column;
+
+    column.push_back(1);
+    column.push_back(ul::nullopt);
+    column.push_back(ul::optional<int>(3));
+    column.push_back(ul::optional<int>());
+
+    REQUIRE(column.size() == 4);
+    CHECK(column.has_value(0));
+    CHECK_FALSE(column.has_value(1));
+    CHECK(column.has_value(2));
+    CHECK_FALSE(column.has_value(3));
+    CHECK(column.validity()[0] == 0b0101);
+
+    SECTION("proxy behaves like an optional reference") {
+	auto first = column[0];
+
+	CHECK(first.has_value());
+	CHECK(*first == 1);
+	CHECK(column[1].value_or(7) == 7);
+	CHECK_THROWS_AS(column[1].value(), ul::bad_optional_access);
+
+	column[1] = 2;
+	CHECK(column.has_value(1));
+	CHECK(*column[1] == 2);
+
+	column[0] = ul::nullopt;
+	CHECK_FALSE(column[0]);
+
+	column[3] = column[2];
+	CHECK(*column[3] == 3);
+
+	ul::optional<int&> ref = column[2];
+	*ref = 30;
+	CHECK(column.values()[2] == 30);
+    }
+
+    SECTION("const access yields optional<const T&>") {
+	const auto& view = column;
+
+	CHECK(&*view[0] == view.values());
+	CHECK_FALSE(view[1].has_value());
+	CHECK_THROWS_AS(view.at(4), std::out_of_range);
+    }
+
+    SECTION("pop_back and resize") {
+	column.pop_back();
+	column.pop_back();
+	CHECK(column.size() == 2);
+	CHECK(column.validity()[0] == 0b01);
+
+	column.resize(100);
+	CHECK(column.size() == 100);
+	CHECK(column.engaged_count() == 1);
+
+	column.resize(1);
+	CHECK(column.engaged_count() == 1);
+	CHECK(column.validity()[0] == 0b1);
+    }
+}
+
+TEST_CASE("bulk operations of optional_array", "[optional_array]") {
+    for (std::size_t size : {0, 1, 63, 64, 65, 200, 1000}) {
+	const auto column = make_column<double>(size);
+
+	double sum = 0;
+	std::size_t engaged = 0;
+	std::vector<double> expected;
+
+	for (std::size_t i = 0; i < size; ++i) {
+	    const bool valid = i % 3 != 0;
+	    sum += valid ? static_cast<double>(i) : 0.0;
+	    engaged += valid;
+	    expected.push_back(valid ? static_cast<double>(i) : -1.0);
+	}
+
+	REQUIRE(column.engaged_count() == engaged);
+	REQUIRE(column.sum() == sum);
+
+	std::vector<double> filled(size);
+	REQUIRE(column.value_or(-1.0, filled.data()) == filled.data() + size);
+	REQUIRE(filled == expected);
+
+	if (engaged > 0) {
+	    REQUIRE(*column.min() == 1.0);
+	    REQUIRE(*column.max() == static_cast<double>(size % 3 == 1 ? size - 2 : size - 1));
+	}
+	else {
+	    REQUIRE_FALSE(column.min().has_value());
+	    REQUIRE_FALSE(column.max().has_value());
+	}
+    }
+
+    SECTION("all engaged and all empty words") {
+	ul::optional_array<std::int32_t> column;
+
+	for (int i = 0; i < 64; ++i) column.push_back(i - 10);
+	for (int i = 0; i < 64; ++i) column.push_back(ul::nullopt);
+	column.push_back(1000);
+
+	CHECK(column.engaged_count() == 65);
+	CHECK(column.sum<std::int64_t>() == 64 * 63 / 2 - 640 + 1000);
+	CHECK(*column.min() == -10);
+	CHECK(*column.max() == 1000);
+    }
+
+    SECTION("min and max ignore NaN") {
+	ul::optional_array<float> column;
+	column.push_back(std::numeric_limits<float>::quiet_NaN());
+	column.push_back(2.0f);
+	column.push_back(-1.0f);
+
+	CHECK(*column.min() == -1.0f);
+	CHECK(*column.max() == 2.0f);
+    }
+
+    SECTION("min and max of only NaN values are empty") {
+	ul::optional_array<double> column;
+	column.push_back(std::numeric_limits<double>::quiet_NaN());
+	column.push_back(ul::nullopt);
+	column.push_back(std::numeric_limits<double>::quiet_NaN());
+
+	CHECK_FALSE(column.min().has_value());
+	CHECK_FALSE(column.max().has_value());
+
+	column.push_back(std::numeric_limits<double>::infinity());
+
+	CHECK(*column.min() == std::numeric_limits<double>::infinity());
+	CHECK(*column.max() == std::numeric_limits<double>::infinity());
+    }
+}
+
+TEST_CASE("non-arithmetic values in optional_array", "[optional_array]") {
+    ul::optional_array<std::string> column(3);
+
+    CHECK(column.engaged_count() == 0);
+
+    column[1] = "one";
+    column.emplace_back(3, 'x');
+    column.push_back(column.values()[1]);
+
+    CHECK(column.engaged_count() == 3);
+    CHECK(*column[3] == "xxx");
+    CHECK(*column[4] == "one");
+
+    std::vector<std::string> filled(column.size());
+    column.value_or("-", filled.data());
+    CHECK(filled == std::vector<std::string>{"-", "one", "-", "xxx", "one"});
+
+    ul::optional_array<std::string> moved(std::move(column));
+    CHECK(moved.size() == 5);
+    CHECK(column.empty());
+}
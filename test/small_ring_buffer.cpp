@@ -0,0 +1,173 @@
+// Copyright Marcus Larsson 2018
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include <catch2/catch.hpp>
+#include <umlaut/small_ring_buffer.hpp>
+#include <algorithm>
+#include <deque>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+TEST_CASE("queue operations of small_ring_buffer", "[small_ring_buffer]") {
+    SECTION("FIFO within the inline capacity never allocates") {
+	ul::small_ring_buffer<int, 4> queue;
+
+	for (int i = 0; i < 1000; ++i) {
+	    queue.push_back(i);
+
+	    if (queue.size() == 3) {
+		REQUIRE(queue.front() == i - 2);
+		queue.pop_front();
+	    }
+	}
+
+	CHECK(queue.is_inline());
+	CHECK(queue.capacity() == 4);
+	CHECK(queue.size() == 2);
+	CHECK(queue.front() == 998);
+	CHECK(queue.back() == 999);
+    }
+
+    SECTION("push_front and pop_back") {
+	ul::small_ring_buffer<int, 4> ring;
+
+	ring.push_front(1);
+	ring.push_front(2);
+	ring.push_back(3);
+
+	CHECK(ring[0] == 2);
+	CHECK(ring[1] == 1);
+	CHECK(ring[2] == 3);
+
+	ring.pop_back();
+	CHECK(ring.back() == 1);
+	CHECK(ring.size() == 2);
+    }
+
+    SECTION("behaves like std::deque when growing while wrapped") {
+	ul::small_ring_buffer<int, 3> ring;
+	std::deque<int> expected;
+
+	for (int i = 0; i < 200; ++i) {
+	    if (i % 3 == 0) {
+		ring.push_front(i);
+		expected.push_front(i);
+	    }
+	    else {
+		ring.push_back(i);
+		expected.push_back(i);
+	    }
+
+	    if (i % 5 == 0) {
+		ring.pop_front();
+		expected.pop_front();
+	    }
+
+	    REQUIRE(ring.size() == expected.size());
+	    REQUIRE(std::equal(ring.begin(), ring.end(), expected.begin(), expected.end()));
+	}
+
+	CHECK_FALSE(ring.is_inline());
+    }
+
+    SECTION("emplace from an element of the full buffer") {
+	ul::small_ring_buffer<std::string, 2> ring;
+	ring.emplace_back(20, 'a');
+	ring.emplace_front(20, 'b');
+
+	ring.push_back(ring.front());
+	ring.push_front(ring.back());
+
+	CHECK(ring.size() == 4);
+	CHECK(ring[0] == std::string(20, 'b'));
+	CHECK(ring[1] == std::string(20, 'b'));
+	CHECK(ring[2] == std::string(20, 'a'));
+	CHECK(ring[3] == std::string(20, 'b'));
+    }
+
+    SECTION("zero inline capacity") {
+	ul::small_ring_buffer<int, 0> ring;
+	ring.push_front(1);
+	ring.push_back(2);
+
+	CHECK(ring.size() == 2);
+	CHECK(ring.front() == 1);
+	CHECK(ring.back() == 2);
+    }
+
+    SECTION("at and clear") {
+	ul::small_ring_buffer<int, 4> ring(ul::list_construct, 1, 2, 3);
+
+	CHECK(ring.at(2) == 3);
+	CHECK_THROWS_AS(ring.at(3), std::out_of_range);
+
+	ring.clear();
+	CHECK(ring.empty());
+    }
+}
+
+TEST_CASE("iterators of small_ring_buffer", "[small_ring_buffer]") {
+    ul::small_ring_buffer<int, 8> ring;
+
+    for (int i = 0; i < 6; ++i) ring.push_back(i);
+    for (int i = 0; i < 4; ++i) ring.pop_front();
+    for (int i = 6; i < 10; ++i) ring.push_back(i);
+
+    CHECK(ring.is_inline());
+    CHECK(ring.end() - ring.begin() == 6);
+    CHECK(std::accumulate(ring.begin(), ring.end(), 0) == 4 + 5 + 6 + 7 + 8 + 9);
+    CHECK(*(ring.begin() + 3) == 7);
+    CHECK(*ring.rbegin() == 9);
+
+    ul::small_ring_buffer<int, 8>::const_iterator it = ring.begin();
+    CHECK(it[5] == 9);
+
+    std::sort(ring.begin(), ring.end(), [](int a, int b) { return a > b; });
+    CHECK(ring.front() == 9);
+    CHECK(ring.back() == 4);
+}
+
+TEST_CASE("copy and move of small_ring_buffer", "[small_ring_buffer]") {
+    SECTION("inline") {
+	ul::small_ring_buffer<std::string, 4> a;
+	a.push_back("b");
+	a.push_front("a");
+
+	ul::small_ring_buffer<std::string, 4> b(a);
+	ul::small_ring_buffer<std::string, 4> c(std::move(a));
+
+	CHECK(a.empty());
+	CHECK(b.size() == 2);
+	CHECK(c.front() == "a");
+	CHECK(c.back() == "b");
+	CHECK(std::equal(b.begin(), b.end(), c.begin(), c.end()));
+    }
+
+    SECTION("heap allocation is stolen on move") {
+	ul::small_ring_buffer<int, 2> a(ul::list_construct, 1, 2, 3, 4);
+	const int* first = &a.front();
+
+	ul::small_ring_buffer<int, 2> b;
+	b = std::move(a);
+
+	CHECK(&b.front() == first);
+	CHECK(b.size() == 4);
+	CHECK(a.empty());
+	CHECK(a.is_inline());
+
+	a.push_back(5);
+	CHECK(a.front() == 5);
+    }
+
+    SECTION("copy assignment") {
+	ul::small_ring_buffer<int, 2> a(ul::list_construct, 1, 2, 3);
+	ul::small_ring_buffer<int, 2> b(ul::list_construct, 9);
+
+	b = a;
+
+	CHECK(std::equal(a.begin(), a.end(), b.begin(), b.end()));
+    }
+}
@@ -0,0 +1,288 @@
+// Copyright Marcus Larsson 2018
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include <catch2/catch.hpp>
+#include <umlaut/small_string.hpp>
+#include <cstring>
+#include <functional>
+#include <list>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+
+namespace {
+
+std::size_t view_length(std::string_view view) { return view.size(); }
+
+template <typename T>
+struct failing_allocator {
+    using value_type = T;
+
+    static inline bool fail = false;
+
+    failing_allocator() = default;
+
+    template <typename U>
+    failing_allocator(const failing_allocator<U>&) {}
+
+    T* allocate(std::size_t n) {
+	if (fail) throw std::bad_alloc();
+	return std::allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T* ptr, std::size_t n) { std::allocator<T>{}.deallocate(ptr, n); }
+
+    bool operator==(const failing_allocator&) const { return true; }
+    bool operator!=(const failing_allocator&) const { return false; }
+};
+
+} // namespace
+
+TEST_CASE("construction of small_string", "[small_string]") {
+    SECTION("default constructed string is empty and null terminated") {
+	ul::small_string<8> str;
+
+	CHECK(str.empty());
+	CHECK(str.size() == 0);
+	CHECK(str.capacity() == 8);
+	CHECK(str.is_inline());
+	CHECK(*str.c_str() == '\0');
+    }
+
+    SECTION("keys up to the inline capacity do not allocate") {
+	const std::string key(40, 'k');
+	ul::small_string<48> str(key);
+
+	CHECK(str.is_inline());
+	CHECK(str == key);
+	CHECK(std::strlen(str.c_str()) == 40);
+    }
+
+    SECTION("longer strings spill to the heap") {
+	ul::small_string<4> str("hello world");
+
+	CHECK_FALSE(str.is_inline());
+	CHECK(str == "hello world");
+	CHECK(str.c_str()[str.size()] == '\0');
+    }
+
+    SECTION("from pointer and count, fill and iterators") {
+	CHECK(ul::small_string<8>("abcdef", 3) == "abc");
+	CHECK(ul::small_string<8>(3, 'x') == "xxx");
+
+	const std::list<char> chars{'a', 'b', 'c'};
+	CHECK(ul::small_string<8>(chars.begin(), chars.end()) == "abc");
+    }
+
+    SECTION("from a small_string of another inline capacity") {
+	ul::small_string<4> small("abcdefgh");
+	ul::small_string<16> large(small);
+
+	CHECK(large == small);
+	CHECK(large.is_inline());
+    }
+}
+
+TEST_CASE("copy and move of small_string", "[small_string]") {
+    SECTION("inline") {
+	ul::small_string<16> a("inline");
+	ul::small_string<16> b(a);
+	ul::small_string<16> c(std::move(a));
+
+	CHECK(b == "inline");
+	CHECK(c == "inline");
+	CHECK(a.empty());
+	CHECK(*a.c_str() == '\0');
+
+	a += "reused";
+	CHECK(a == "reused");
+    }
+
+    SECTION("heap allocation is stolen on move") {
+	ul::small_string<4> a("on the heap");
+	const char* chars = a.data();
+
+	ul::small_string<4> b;
+	b = std::move(a);
+
+	CHECK(b.data() == chars);
+	CHECK(b == "on the heap");
+	CHECK(a.empty());
+	CHECK(a.is_inline());
+    }
+
+    SECTION("swap") {
+	ul::small_string<4> a("ab");
+	ul::small_string<4> b("on the heap");
+
+	swap(a, b);
+
+	CHECK(a == "on the heap");
+	CHECK(b == "ab");
+	CHECK(b.c_str()[2] == '\0');
+    }
+}
+
+TEST_CASE("string_view interop of small_string", "[small_string]") {
+    ul::small_string<16> str("hello");
+
+    SECTION("converts implicitly without copying") {
+	const std::string_view view = str;
+
+	CHECK(view.data() == str.data());
+	CHECK(view.size() == 5);
+	CHECK(view_length(str) == 5);
+    }
+
+    SECTION("comparisons") {
+	CHECK(str == std::string_view("hello"));
+	CHECK(std::string_view("hello") == str);
+	CHECK(str == std::string("hello"));
+	CHECK(str != "hell");
+	CHECK("hell" != str);
+	CHECK(str < "help");
+	CHECK("help" > str);
+	CHECK(str <= "hello");
+	CHECK(str >= "hello");
+	CHECK(str == ul::small_string<2>("hello"));
+	CHECK(str < ul::small_string<2>("world"));
+    }
+
+    SECTION("hash agrees with std::string_view") {
+	CHECK(std::hash<ul::small_string<16>>{}(str) == std::hash<std::string_view>{}("hello"));
+
+	std::unordered_set<ul::small_string<16>> set;
+	set.insert(str);
+	CHECK(set.count(ul::small_string<16>("hello")) == 1);
+    }
+
+    SECTION("stream output") {
+	std::ostringstream os;
+	os << str;
+	CHECK(os.str() == "hello");
+    }
+}
+
+TEST_CASE("modifiers of small_string", "[small_string]") {
+    ul::small_string<8> str;
+
+    SECTION("append grows geometrically and keeps the terminator") {
+	std::string expected;
+
+	for (int i = 0; i < 100; ++i) {
+	    str += "ab";
+	    str += 'c';
+	    expected += "abc";
+
+	    REQUIRE(str == expected);
+	    REQUIRE(str.c_str()[str.size()] == '\0');
+	}
+
+	CHECK(str.capacity() < 2 * expected.size() + 8);
+    }
+
+    SECTION("append from the string itself") {
+	str = "abcdef";
+	str.append(str.data() + 1, 3);
+	CHECK(str == "abcdefbcd");
+
+	str.append(str);
+	CHECK(str == "abcdefbcdabcdefbcd");
+    }
+
+    SECTION("append ranges") {
+	const char chars[] = {'x', 'y', 'z'};
+	str.append(std::begin(chars), std::end(chars));
+	str.append(2, '!');
+
+	const std::list<char> more{'1', '2'};
+	str.append(more.begin(), more.end());
+
+	CHECK(str == "xyz!!12");
+    }
+
+    SECTION("assign") {
+	str.assign("a much longer string");
+	CHECK(str == "a much longer string");
+
+	str.assign(str.data() + 2, 4);
+	CHECK(str == "much");
+
+	str = std::string("short");
+	CHECK(str == "short");
+
+	str.assign(2, 'z');
+	CHECK(str == "zz");
+    }
+
+    SECTION("push_back, pop_back and element access") {
+	str.push_back('a');
+	str.push_back('b');
+
+	CHECK(str.front() == 'a');
+	CHECK(str.back() == 'b');
+	CHECK(str[1] == 'b');
+	CHECK_THROWS_AS(str.at(2), std::out_of_range);
+
+	str.pop_back();
+	CHECK(str == "a");
+	CHECK(str.c_str()[1] == '\0');
+    }
+
+    SECTION("push_back keeps the string intact if growing throws") {
+	ul::basic_small_string<4, char, std::char_traits<char>, failing_allocator<char>> full("abcd");
+
+	failing_allocator<char>::fail = true;
+	CHECK_THROWS_AS(full.push_back('e'), std::bad_alloc);
+	failing_allocator<char>::fail = false;
+
+	CHECK(full.size() == 4);
+	CHECK(std::strcmp(full.c_str(), "abcd") == 0);
+    }
+
+    SECTION("erase") {
+	str = "abcdef";
+
+	str.erase(1, 2);
+	CHECK(str == "adef");
+
+	str.erase(str.begin() + 2);
+	CHECK(str == "adf");
+
+	str.erase(1);
+	CHECK(str == "a");
+
+	CHECK_THROWS_AS(str.erase(2), std::out_of_range);
+    }
+
+    SECTION("resize and clear") {
+	str = "abc";
+
+	str.resize(5, 'x');
+	CHECK(str == "abcxx");
+
+	str.resize(2);
+	CHECK(str == "ab");
+	CHECK(str.c_str()[2] == '\0');
+
+	str.clear();
+	CHECK(str.empty());
+	CHECK(*str.c_str() == '\0');
+    }
+
+    SECTION("reserve and shrink_to_fit") {
+	str.reserve(32);
+	CHECK(str.capacity() >= 32);
+	CHECK_FALSE(str.is_inline());
+
+	str = "abc";
+	str.shrink_to_fit();
+	CHECK(str.is_inline());
+	CHECK(str == "abc");
+    }
+}
@@ -4,6 +4,17 @@
 
 #include <catch2/catch.hpp>
 #include <umlaut/small_vector.hpp>
+#include <umlaut/optional.hpp>
+#include <string>
+#include <list>
+#include <sstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
 
 TEST_CASE("construction of small_vector_base", "[small_vector_base]") {
     struct type {
@@ -51,3 +62,769 @@ TEST_CASE("construction of small_vector_base", "[small_vector_base]") {
 	CHECK(v[1].m_j == 4);
     }
 }
+
+TEST_CASE("inline storage of small_vector", "[small_vector]") {
+    ul::small_vector<int, 4> v;
+
+    auto inside = [&v](const int* ptr) {
+	auto first = reinterpret_cast<const unsigned char*>(&v);
+	auto last = first + sizeof(v);
+	auto p = reinterpret_cast<const unsigned char*>(ptr);
+	return p >= first && p < last;
+    };
+
+    CHECK(v.empty());
+    CHECK(v.capacity() == 4);
+    CHECK(v.is_inline());
+
+    SECTION("elements up to the inline capacity are stored in the object") {
+	for (int i = 0; i < 4; ++i) v.push_back(i);
+
+	CHECK(v.size() == 4);
+	CHECK(v.capacity() == 4);
+	CHECK(v.is_inline());
+	CHECK(inside(v.data()));
+    }
+
+    SECTION("spill to the heap when the inline capacity is exceeded") {
+	for (int i = 0; i < 5; ++i) v.push_back(i);
+
+	CHECK(v.size() == 5);
+	CHECK(v.capacity() >= 5);
+	CHECK_FALSE(v.is_inline());
+	CHECK_FALSE(inside(v.data()));
+
+	for (int i = 0; i < 5; ++i) CHECK(v[i] == i);
+    }
+
+    SECTION("usable through a reference to small_vector_base") {
+	ul::small_vector_base<int>& base = v;
+
+	for (int i = 0; i < 10; ++i) base.emplace_back(i);
+
+	CHECK(v.size() == 10);
+	for (int i = 0; i < 10; ++i) CHECK(v[i] == i);
+    }
+}
+
+TEST_CASE("copy and move of small_vector", "[small_vector]") {
+    ul::small_vector<std::string, 2> small(ul::list_construct, "a", "b");
+    ul::small_vector<std::string, 2> large(ul::list_construct, "a", "b", "c");
+
+    SECTION("copy construction") {
+	auto small_copy = small;
+	auto large_copy = large;
+
+	CHECK(small_copy.is_inline());
+	CHECK(small_copy.size() == 2);
+	CHECK(small_copy[1] == "b");
+	CHECK(large_copy.size() == 3);
+	CHECK(large_copy[2] == "c");
+    }
+
+    SECTION("move construction of inline elements") {
+	auto moved = std::move(small);
+
+	CHECK(moved.is_inline());
+	CHECK(moved.size() == 2);
+	CHECK(moved[0] == "a");
+	CHECK(small.empty());
+    }
+
+    SECTION("move construction steals the heap allocation") {
+	const auto* data = large.data();
+	auto moved = std::move(large);
+
+	CHECK(moved.data() == data);
+	CHECK(moved.size() == 3);
+	CHECK(large.empty());
+	CHECK(large.is_inline());
+	CHECK(large.capacity() == 2);
+    }
+
+    SECTION("assignment") {
+	small = large;
+
+	CHECK(small.size() == 3);
+	CHECK(small[2] == "c");
+
+	large = std::move(small);
+
+	CHECK(large.size() == 3);
+	CHECK(small.empty());
+	CHECK(small.capacity() == 2);
+    }
+}
+
+namespace {
+
+struct counters {
+    int copies = 0;
+    int moves = 0;
+};
+
+template <bool NothrowMove, bool Relocatable>
+struct tracked {
+    using is_trivially_relocatable = std::bool_constant<Relocatable>;
+
+    tracked(counters& c, int value) : c(&c), value(value) {}
+    tracked(const tracked& other) : c(other.c), value(other.value) { ++c->copies; }
+    tracked(tracked&& other) noexcept(NothrowMove) : c(other.c), value(other.value) { ++c->moves; }
+    ~tracked() { value = -1; }
+
+    counters* c;
+    int value;
+};
+
+template <typename T>
+struct counting_allocator {
+    using value_type = T;
+
+    counting_allocator(int& allocations) : allocations(&allocations) {}
+
+    template <typename U>
+    counting_allocator(const counting_allocator<U>& other) : allocations(other.allocations) {}
+
+    T* allocate(std::size_t n) {
+	++*allocations;
+	return std::allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T* ptr, std::size_t n) { std::allocator<T>{}.deallocate(ptr, n); }
+
+    bool operator==(const counting_allocator& other) const { return allocations == other.allocations; }
+    bool operator!=(const counting_allocator& other) const { return allocations != other.allocations; }
+
+    int* allocations;
+};
+
+} // namespace
+
+TEST_CASE("growth of small_vector_base", "[small_vector_base]") {
+    SECTION("geometric growth") {
+	int allocations = 0;
+	ul::small_vector_base<int, counting_allocator<int>> v{counting_allocator<int>(allocations)};
+
+	for (int i = 0; i < 1000; ++i) v.push_back(i);
+
+	CHECK(v.size() == 1000);
+	CHECK(allocations < 20);
+	for (int i = 0; i < 1000; ++i) CHECK(v[i] == i);
+    }
+
+    SECTION("reserve keeps the elements") {
+	ul::small_vector<std::string, 2> v(ul::list_construct, "a", "b");
+	v.reserve(100);
+
+	CHECK(v.capacity() == 100);
+	CHECK(v[0] == "a");
+	CHECK(v[1] == "b");
+    }
+
+    SECTION("emplace_back of an element of the vector itself") {
+	ul::small_vector<std::string, 1> v(ul::list_construct, "a");
+	v.push_back(v[0]);
+
+	CHECK(v[0] == "a");
+	CHECK(v[1] == "a");
+    }
+
+    SECTION("trivially relocatable elements are neither moved nor copied") {
+	counters c;
+	ul::small_vector<tracked<false, true>, 1> v;
+
+	for (int i = 0; i < 10; ++i) v.emplace_back(c, i);
+
+	CHECK(c.moves == 0);
+	CHECK(c.copies == 0);
+	for (int i = 0; i < 10; ++i) CHECK(v[i].value == i);
+    }
+
+    SECTION("elements with a noexcept move constructor are moved") {
+	counters c;
+	ul::small_vector<tracked<true, false>, 1> v;
+
+	for (int i = 0; i < 10; ++i) v.emplace_back(c, i);
+
+	CHECK(c.moves > 0);
+	CHECK(c.copies == 0);
+    }
+
+    SECTION("elements with a throwing move constructor are copied") {
+	counters c;
+	ul::small_vector<tracked<false, false>, 1> v;
+
+	for (int i = 0; i < 10; ++i) v.emplace_back(c, i);
+
+	CHECK(c.moves == 0);
+	CHECK(c.copies > 0);
+    }
+}
+
+TEST_CASE("range modifiers of small_vector_base", "[small_vector_base]") {
+    const int numbers[] = {1, 2, 3, 4, 5};
+    const std::list<std::string> strings = {"x", "y", "z"};
+
+    SECTION("append a contiguous range") {
+	ul::small_vector<int, 4> v(ul::list_construct, 0);
+	v.append(std::begin(numbers), std::end(numbers));
+
+	REQUIRE(v.size() == 6);
+	for (int i = 0; i < 6; ++i) CHECK(v[i] == i);
+    }
+
+    SECTION("append a non-contiguous range") {
+	ul::small_vector<std::string, 2> v(ul::list_construct, "w");
+	v.append(strings.begin(), strings.end());
+
+	REQUIRE(v.size() == 4);
+	CHECK(v[0] == "w");
+	CHECK(v[3] == "z");
+    }
+
+    SECTION("append an input range") {
+	std::istringstream stream("1 2 3");
+	ul::small_vector_base<int> v;
+	v.append(std::istream_iterator<int>(stream), std::istream_iterator<int>());
+
+	REQUIRE(v.size() == 3);
+	CHECK(v[2] == 3);
+    }
+
+    SECTION("insert within the capacity") {
+	ul::small_vector<int, 8> v(ul::list_construct, 0, 6);
+	auto it = v.insert(v.begin() + 1, std::begin(numbers), std::end(numbers));
+
+	CHECK(it == v.begin() + 1);
+	CHECK(v.is_inline());
+	REQUIRE(v.size() == 7);
+	for (int i = 0; i < 7; ++i) CHECK(v[i] == i);
+    }
+
+    SECTION("insert within the capacity, non trivially relocatable") {
+	ul::small_vector<std::string, 8> v(ul::list_construct, "a", "b", "c");
+	v.insert(v.begin() + 1, strings.begin(), strings.end());
+
+	CHECK(v.is_inline());
+	REQUIRE(v.size() == 6);
+	CHECK(v[0] == "a");
+	CHECK(v[1] == "x");
+	CHECK(v[3] == "z");
+	CHECK(v[4] == "b");
+	CHECK(v[5] == "c");
+    }
+
+    SECTION("insert beyond the capacity") {
+	ul::small_vector<std::string, 2> v(ul::list_construct, "a", "b");
+	auto it = v.insert(v.begin() + 1, strings.begin(), strings.end());
+
+	CHECK(*it == "x");
+	REQUIRE(v.size() == 5);
+	CHECK(v[0] == "a");
+	CHECK(v[1] == "x");
+	CHECK(v[3] == "z");
+	CHECK(v[4] == "b");
+    }
+
+    SECTION("insert an input range") {
+	std::istringstream stream("1 2");
+	ul::small_vector<int, 2> v(ul::list_construct, 0, 3);
+	v.insert(v.begin() + 1, std::istream_iterator<int>(stream), std::istream_iterator<int>());
+
+	REQUIRE(v.size() == 4);
+	for (int i = 0; i < 4; ++i) CHECK(v[i] == i);
+    }
+
+    SECTION("assign a range") {
+	ul::small_vector<std::string, 2> v(ul::list_construct, "a");
+	v.assign(strings.begin(), strings.end());
+
+	REQUIRE(v.size() == 3);
+	CHECK(v[0] == "x");
+	CHECK(v[2] == "z");
+
+	v.assign(strings.begin(), std::next(strings.begin()));
+
+	REQUIRE(v.size() == 1);
+	CHECK(v[0] == "x");
+    }
+}
+
+TEST_CASE("modifiers of small_vector_base", "[small_vector_base]") {
+    ul::small_vector<std::string, 4> v(ul::list_construct, "a", "b", "c");
+
+    SECTION("emplace in the middle") {
+	auto it = v.emplace(v.begin() + 1, 3, 'x');
+
+	CHECK(*it == "xxx");
+	REQUIRE(v.size() == 4);
+	CHECK(v[0] == "a");
+	CHECK(v[2] == "b");
+	CHECK(v[3] == "c");
+    }
+
+    SECTION("emplace when full") {
+	v.push_back("d");
+	v.emplace(v.begin(), "e");
+
+	REQUIRE(v.size() == 5);
+	CHECK(v[0] == "e");
+	CHECK(v[4] == "d");
+    }
+
+    SECTION("insert an element of the vector itself") {
+	v.insert(v.begin(), v[2]);
+
+	REQUIRE(v.size() == 4);
+	CHECK(v[0] == "c");
+	CHECK(v[3] == "c");
+
+	v.insert(v.begin(), v[1]);
+
+	REQUIRE(v.size() == 5);
+	CHECK(v[0] == "a");
+    }
+
+    SECTION("insert copies of a value") {
+	v.insert(v.begin() + 1, 2, v[2]);
+
+	REQUIRE(v.size() == 5);
+	CHECK(v[1] == "c");
+	CHECK(v[2] == "c");
+	CHECK(v[3] == "b");
+
+	v.insert(v.end(), 3, "z");
+
+	REQUIRE(v.size() == 8);
+	CHECK(v[7] == "z");
+    }
+
+    SECTION("insert elements of an inline vector at the edges of the gap") {
+	ul::small_vector<int, 16> ints(ul::list_construct, 0, 1, 2, 3);
+
+	ints.insert(ints.begin() + 1, ints[1]);
+	ints.insert(ints.begin() + 1, ints[0]);
+	ints.insert(ints.end() - 1, ints[ints.size() - 1]);
+
+	CHECK(std::vector<int>(ints.begin(), ints.end()) == std::vector<int>{0, 0, 1, 1, 2, 3, 3});
+
+	ints.insert(ints.begin() + 2, 2, ints[2]);
+	ints.insert(ints.begin(), 3, ints[ints.size() - 1]);
+
+	CHECK(std::vector<int>(ints.begin(), ints.end()) == std::vector<int>{3, 3, 3, 0, 0, 1, 1, 1, 1, 2, 3, 3});
+    }
+
+    SECTION("erase") {
+	auto it = v.erase(v.begin());
+
+	CHECK(*it == "b");
+	REQUIRE(v.size() == 2);
+
+	it = v.erase(v.begin(), v.end());
+
+	CHECK(it == v.end());
+	CHECK(v.empty());
+    }
+
+    SECTION("pop_back and clear") {
+	v.pop_back();
+
+	REQUIRE(v.size() == 2);
+	CHECK(v[1] == "b");
+
+	v.clear();
+
+	CHECK(v.empty());
+	CHECK(v.capacity() == 4);
+    }
+
+    SECTION("resize") {
+	v.resize(6);
+
+	REQUIRE(v.size() == 6);
+	CHECK(v[2] == "c");
+	CHECK(v[5].empty());
+
+	v.resize(1);
+
+	REQUIRE(v.size() == 1);
+	CHECK(v[0] == "a");
+
+	v.resize(5, v[0]);
+
+	REQUIRE(v.size() == 5);
+	CHECK(v[4] == "a");
+    }
+}
+
+TEST_CASE("relocation of unique_ptr in small_vector_base", "[small_vector_base]") {
+    static_assert(ul::is_trivially_relocatable_v<std::unique_ptr<int>>);
+
+    ul::small_vector<std::unique_ptr<int>, 2> v;
+
+    for (int i = 0; i < 5; ++i) v.push_back(std::make_unique<int>(i));
+
+    v.erase(v.begin() + 1);
+    v.insert(v.begin(), std::make_unique<int>(10));
+    v.emplace(v.begin() + 2, new int(20));
+
+    REQUIRE(v.size() == 6);
+    CHECK(*v[0] == 10);
+    CHECK(*v[1] == 0);
+    CHECK(*v[2] == 20);
+    CHECK(*v[3] == 2);
+    CHECK(*v[5] == 4);
+}
+
+TEST_CASE("relocation of optional unique_ptr in small_vector_base", "[small_vector_base]") {
+    static_assert(ul::is_trivially_relocatable_v<ul::optional<std::unique_ptr<int>>>);
+
+    ul::small_vector<ul::optional<std::unique_ptr<int>>, 2> v;
+
+    for (int i = 0; i < 5; ++i) {
+	if (i % 2 == 0) v.emplace_back(std::make_unique<int>(i));
+	else v.emplace_back(ul::nullopt);
+    }
+
+    v.erase(v.begin());
+    v.insert(v.begin() + 1, std::make_unique<int>(10));
+
+    REQUIRE(v.size() == 5);
+    CHECK_FALSE(v[0].has_value());
+    CHECK(**v[1] == 10);
+    CHECK(**v[2] == 2);
+    CHECK_FALSE(v[3].has_value());
+    CHECK(**v[4] == 4);
+}
+
+TEST_CASE("unchecked appends to small_vector_base", "[small_vector_base]") {
+    SECTION("emplace_back_unchecked after reserve") {
+	ul::small_vector_base<std::string> v;
+	v.reserve(3);
+
+	v.emplace_back_unchecked(2, 'a');
+	v.push_back_unchecked("b");
+	v.push_back_unchecked(v[1]);
+
+	REQUIRE(v.size() == 3);
+	CHECK(v[0] == "aa");
+	CHECK(v[2] == "b");
+    }
+
+    SECTION("fill_guard updates the size when destroyed") {
+	ul::small_vector<int, 4> v(ul::list_construct, 0);
+
+	{
+	    auto guard = v.reserve_fill(100);
+
+	    for (int i = 1; i <= 100; ++i) guard.push_back(i);
+
+	    CHECK(v.size() == 1);
+	}
+
+	REQUIRE(v.size() == 101);
+	CHECK(v.capacity() >= 101);
+	for (int i = 0; i <= 100; ++i) CHECK(v[i] == i);
+    }
+
+    SECTION("fill_guard keeps the elements constructed before an exception") {
+	struct throwing {
+	    throwing(int value) : value(value) {
+		if (value == 3) throw std::runtime_error("throwing");
+	    }
+	    int value;
+	};
+
+	ul::small_vector<throwing, 8> v;
+
+	try {
+	    auto guard = v.reserve_fill(5);
+	    for (int i = 0; i < 5; ++i) guard.emplace_back(i);
+	}
+	catch (const std::runtime_error&) {}
+
+	REQUIRE(v.size() == 3);
+	CHECK(v[2].value == 2);
+    }
+}
+
+TEST_CASE("shrinking of small_vector", "[small_vector]") {
+    ul::small_vector<std::string, 4> v(ul::list_construct, "a", "b", "c", "d", "e", "f");
+    v.reserve(100);
+
+    SECTION("shrink_to_fit moves the elements back into the inline buffer") {
+	v.erase(v.begin() + 2, v.end());
+	v.shrink_to_fit();
+
+	CHECK(v.is_inline());
+	CHECK(v.capacity() == 4);
+	REQUIRE(v.size() == 2);
+	CHECK(v[1] == "b");
+    }
+
+    SECTION("shrink_to_fit reallocates to the exact size") {
+	v.shrink_to_fit();
+
+	CHECK_FALSE(v.is_inline());
+	CHECK(v.capacity() == 6);
+	REQUIRE(v.size() == 6);
+	CHECK(v[5] == "f");
+    }
+
+    SECTION("compact only moves the elements back into the inline buffer") {
+	CHECK_FALSE(v.compact());
+	CHECK(v.capacity() == 100);
+
+	v.pop_back();
+	v.pop_back();
+
+	CHECK(v.compact());
+	CHECK(v.capacity() == 4);
+	CHECK(v[3] == "d");
+    }
+
+    SECTION("shrink_to_fit through small_vector_base") {
+	ul::small_vector_base<std::string>& base = v;
+	base.shrink_to_fit();
+
+	CHECK(base.capacity() == 6);
+
+	base.clear();
+	base.shrink_to_fit();
+
+	CHECK(base.is_inline());
+    }
+}
+
+namespace {
+
+void append_squares(ul::small_vector_base<int>& v, int count) {
+    for (int i = 0; i < count; ++i) v.push_back(i * i);
+}
+
+int sum(const ul::small_vector_base<int>& v) {
+    int result = 0;
+    for (int value : v) result += value;
+    return result;
+}
+
+} // namespace
+
+TEST_CASE("small_vector_base as a size-erased reference", "[small_vector]") {
+    ul::small_vector<int, 2> small;
+    ul::small_vector<int, 16> large;
+    ul::small_vector_base<int> none;
+
+    append_squares(small, 10);
+    append_squares(large, 10);
+    append_squares(none, 10);
+
+    CHECK_FALSE(small.is_inline());
+    CHECK(large.is_inline());
+    CHECK(sum(small) == 285);
+    CHECK(sum(large) == 285);
+    CHECK(sum(none) == 285);
+
+    SECTION("copy between different inline capacities") {
+	ul::small_vector<int, 16> copy(small);
+
+	CHECK(copy.is_inline());
+	CHECK(sum(copy) == 285);
+
+	small = large;
+
+	CHECK(sum(small) == 285);
+    }
+
+    SECTION("move between different inline capacities") {
+	ul::small_vector<int, 4> from_heap(std::move(small));
+	ul::small_vector<int, 4> from_inline(std::move(large));
+
+	CHECK(sum(from_heap) == 285);
+	CHECK(sum(from_inline) == 285);
+	CHECK(small.empty());
+	CHECK(large.empty());
+
+	append_squares(small, 3);
+	from_heap = std::move(none);
+
+	CHECK(sum(small) == 5);
+	CHECK(sum(from_heap) == 285);
+    }
+}
+
+TEST_CASE("compact header of small_vector_base", "[small_vector_base]") {
+    CHECK(sizeof(ul::compact_small_vector_base<int>) == 2 * sizeof(void*));
+    CHECK(sizeof(ul::compact_small_vector_base<int>) < sizeof(ul::small_vector_base<int>));
+    CHECK(sizeof(ul::compact_small_vector<int, 0>) == sizeof(ul::compact_small_vector_base<int>));
+    CHECK(std::is_same_v<ul::compact_small_vector<int, 2>::size_type, std::uint32_t>);
+
+    ul::compact_small_vector<int, 2> v;
+    ul::compact_small_vector_base<int>& base = v;
+
+    for (int i = 0; i < 100; ++i) base.push_back(i);
+    v.insert(v.begin(), 3, -1);
+    v.erase(v.begin(), v.begin() + 3);
+
+    REQUIRE(v.size() == 100);
+    for (int i = 0; i < 100; ++i) CHECK(v[i] == i);
+    CHECK(v.max_size() <= std::numeric_limits<std::uint32_t>::max());
+}
+
+TEST_CASE("resize_for_overwrite of small_vector_base", "[small_vector_base]") {
+    SECTION("trivial elements are left untouched") {
+	ul::small_vector<int, 8> v(ul::list_construct, 1, 2, 3, 4);
+	v.clear();
+	v.resize_for_overwrite(4);
+
+	REQUIRE(v.size() == 4);
+	CHECK(v[0] == 1);
+	CHECK(v[3] == 4);
+    }
+
+    SECTION("grow and shrink") {
+	ul::small_vector<int, 2> v;
+	v.resize_for_overwrite(100);
+
+	REQUIRE(v.size() == 100);
+	CHECK(v.capacity() >= 100);
+
+	for (int i = 0; i < 100; ++i) v[i] = i;
+	v.resize_for_overwrite(10);
+
+	REQUIRE(v.size() == 10);
+	CHECK(v[9] == 9);
+    }
+
+    SECTION("non-trivial elements are default constructed") {
+	ul::small_vector<std::string, 2> v(ul::list_construct, "a");
+	v.resize_for_overwrite(3);
+
+	REQUIRE(v.size() == 3);
+	CHECK(v[0] == "a");
+	CHECK(v[2].empty());
+    }
+}
+
+TEST_CASE("swap and move of small_vector", "[small_vector]") {
+    using strings = ul::small_vector<std::string, 2>;
+    using pointers = ul::small_vector<std::unique_ptr<int>, 2>;
+
+    CHECK(std::is_nothrow_move_constructible_v<strings>);
+    CHECK(std::is_nothrow_move_assignable_v<strings>);
+    CHECK(std::is_nothrow_swappable_v<strings>);
+    CHECK(std::is_nothrow_move_constructible_v<ul::small_vector<tracked<false, true>, 2>>);
+    CHECK_FALSE(std::is_nothrow_move_constructible_v<ul::small_vector<tracked<false, false>, 2>>);
+
+    SECTION("two heap allocations are swapped by pointer") {
+	strings a(ul::list_construct, "a", "b", "c");
+	strings b(ul::list_construct, "d", "e", "f", "g");
+	const auto* a_data = a.data();
+	const auto* b_data = b.data();
+
+	swap(a, b);
+
+	CHECK(a.data() == b_data);
+	CHECK(b.data() == a_data);
+	CHECK(a.size() == 4);
+	CHECK(a[3] == "g");
+	CHECK(b.size() == 3);
+	CHECK(b[0] == "a");
+    }
+
+    SECTION("inline elements are relocated when swapped with a heap allocation") {
+	strings a(ul::list_construct, "a");
+	strings b(ul::list_construct, "b", "c", "d");
+	const auto* b_data = b.data();
+
+	a.swap(b);
+
+	CHECK(a.data() == b_data);
+	CHECK(a.size() == 3);
+	CHECK(a[2] == "d");
+	CHECK(b.is_inline());
+	CHECK(b.capacity() == 2);
+	REQUIRE(b.size() == 1);
+	CHECK(b[0] == "a");
+
+	b.swap(a);
+
+	CHECK(b.data() == b_data);
+	CHECK(a.is_inline());
+	REQUIRE(a.size() == 1);
+	CHECK(a[0] == "a");
+    }
+
+    SECTION("two inline vectors swap their elements") {
+	strings a(ul::list_construct, "a");
+	strings b(ul::list_construct, "b", "c");
+
+	swap(a, b);
+
+	REQUIRE(a.size() == 2);
+	CHECK(a[0] == "b");
+	CHECK(a[1] == "c");
+	REQUIRE(b.size() == 1);
+	CHECK(b[0] == "a");
+
+	pointers p(ul::list_construct, std::make_unique<int>(1), std::make_unique<int>(2));
+	pointers q;
+
+	swap(p, q);
+
+	CHECK(p.empty());
+	REQUIRE(q.size() == 2);
+	CHECK(*q[1] == 2);
+    }
+
+    SECTION("a vector moved from through a base reference swaps its inline capacity") {
+	ul::small_vector<int, 4> a;
+	ul::small_vector<int, 4> b(ul::list_construct, 1, 2, 3);
+	ul::small_vector<int, 4> c(ul::list_construct, 1, 2, 3, 4, 5);
+	ul::small_vector_base<int>& ra = a;
+	ul::small_vector_base<int>& rc = c;
+
+	ra = std::move(rc);
+	REQUIRE(c.is_inline());
+
+	c.swap(b);
+
+	CHECK(b.empty());
+	CHECK(b.capacity() == 4);
+	CHECK(c.capacity() == 4);
+
+	for (int i = 4; i <= 6; ++i) c.push_back(i);
+
+	REQUIRE(c.size() == 6);
+	CHECK(c[5] == 6);
+	CHECK(a.size() == 5);
+    }
+
+    SECTION("trivially relocatable inline elements are neither moved nor copied") {
+	counters c;
+	ul::small_vector<tracked<false, true>, 4> a;
+	ul::small_vector<tracked<false, true>, 4> b;
+
+	for (int i = 0; i < 3; ++i) a.emplace_back(c, i);
+	b.emplace_back(c, 10);
+
+	swap(a, b);
+	auto moved = std::move(b);
+	a = std::move(moved);
+
+	CHECK(c.moves == 0);
+	CHECK(c.copies == 0);
+	REQUIRE(a.size() == 3);
+	CHECK(a[2].value == 2);
+	CHECK(b.empty());
+	CHECK(moved.empty());
+    }
+
+    SECTION("a std::vector of small vectors moves them when growing") {
+	std::vector<strings> v;
+
+	for (int i = 0; i < 10; ++i) v.push_back(strings(ul::list_construct, std::to_string(i)));
+
+	for (int i = 0; i < 10; ++i) CHECK(v[i][0] == std::to_string(i));
+    }
+}
@@ -0,0 +1,187 @@
+// Copyright Marcus Larsson 2018
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include <catch2/catch.hpp>
+#include <umlaut/static_vector.hpp>
+#include <list>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+TEST_CASE("properties of static_vector", "[static_vector]") {
+    CHECK(std::is_trivially_copyable_v<ul::static_vector<int, 4>>);
+    CHECK_FALSE(std::is_trivially_copyable_v<ul::static_vector<std::string, 4>>);
+    CHECK(std::is_copy_constructible_v<ul::static_vector<std::string, 4>>);
+    CHECK_FALSE(std::is_copy_constructible_v<ul::static_vector<std::unique_ptr<int>, 4>>);
+    CHECK(std::is_nothrow_move_constructible_v<ul::static_vector<std::unique_ptr<int>, 4>>);
+    CHECK(ul::is_trivially_relocatable_v<ul::static_vector<std::unique_ptr<int>, 4>>);
+    CHECK(sizeof(ul::static_vector<char, 7>) == 8);
+    CHECK(ul::static_vector<int, 4>::capacity() == 4);
+}
+
+TEST_CASE("construction of static_vector", "[static_vector]") {
+    struct type {
+	type(int i, int j) : m_i(i), m_j(j) {}
+	int m_i, m_j;
+    };
+
+    SECTION("list_initialization") {
+	ul::static_vector<int, 4> v(ul::list_construct, 1, 2, 3);
+
+	REQUIRE(v.size() == 3);
+	CHECK(v[0] == 1);
+	CHECK(v[2] == 3);
+    }
+
+    SECTION("piecewise_construct") {
+	ul::static_vector<type, 2> v(std::piecewise_construct,
+				     std::forward_as_tuple(1, 2),
+				     std::forward_as_tuple(3, 4));
+
+	REQUIRE(v.size() == 2);
+	CHECK(v[0].m_j == 2);
+	CHECK(v[1].m_i == 3);
+    }
+
+    SECTION("copy and move") {
+	ul::static_vector<std::string, 4> v(ul::list_construct, "a", "b");
+	auto copy = v;
+	auto moved = std::move(v);
+
+	REQUIRE(copy.size() == 2);
+	CHECK(copy[1] == "b");
+	REQUIRE(moved.size() == 2);
+	CHECK(moved[0] == "a");
+
+	copy = ul::static_vector<std::string, 4>(ul::list_construct, "c");
+
+	REQUIRE(copy.size() == 1);
+	CHECK(copy[0] == "c");
+    }
+}
+
+TEST_CASE("modifiers of static_vector", "[static_vector]") {
+    ul::static_vector<std::string, 6> v(ul::list_construct, "a", "b", "c");
+    const std::list<std::string> strings = {"x", "y"};
+
+    SECTION("emplace_back throws when full") {
+	v.emplace_back("d");
+	v.push_back("e");
+	v.push_back_unchecked("f");
+
+	CHECK(v.size() == 6);
+	CHECK_THROWS_AS(v.push_back("g"), std::length_error);
+	CHECK(v.size() == 6);
+    }
+
+    SECTION("insert and erase") {
+	v.insert(v.begin(), v[2]);
+	v.insert(v.begin() + 2, strings.begin(), strings.end());
+
+	REQUIRE(v.size() == 6);
+	CHECK(v[0] == "c");
+	CHECK(v[1] == "a");
+	CHECK(v[2] == "x");
+	CHECK(v[4] == "b");
+	CHECK(v[5] == "c");
+
+	v.erase(v.begin() + 1, v.begin() + 4);
+
+	REQUIRE(v.size() == 3);
+	CHECK(v[1] == "b");
+    }
+
+    SECTION("insert too many elements") {
+	CHECK_THROWS_AS(v.insert(v.begin(), 4, "z"), std::length_error);
+	CHECK(v.size() == 3);
+    }
+
+    SECTION("resize, pop_back and clear") {
+	v.resize(5, "z");
+
+	REQUIRE(v.size() == 5);
+	CHECK(v[4] == "z");
+
+	v.pop_back();
+	v.resize(2);
+
+	REQUIRE(v.size() == 2);
+	CHECK(v[1] == "b");
+
+	v.clear();
+	CHECK(v.empty());
+    }
+
+    SECTION("relocation of trivially relocatable elements") {
+	ul::static_vector<std::unique_ptr<int>, 4> p;
+	p.push_back(std::make_unique<int>(1));
+	p.push_back(std::make_unique<int>(3));
+	p.emplace(p.begin() + 1, new int(2));
+	p.erase(p.begin());
+
+	REQUIRE(p.size() == 2);
+	CHECK(*p[0] == 2);
+	CHECK(*p[1] == 3);
+    }
+
+    SECTION("append and assign contiguous ranges") {
+	const int numbers[] = {1, 2, 3};
+	ul::static_vector<int, 8> n(ul::list_construct, 0);
+	n.append(std::begin(numbers), std::end(numbers));
+
+	REQUIRE(n.size() == 4);
+	CHECK(n[3] == 3);
+
+	n.assign(std::begin(numbers), std::begin(numbers) + 1);
+
+	REQUIRE(n.size() == 1);
+	CHECK(n[0] == 1);
+    }
+
+    SECTION("insert copies of an element of the vector") {
+	v.insert(v.begin(), 2, v[1]);
+
+	REQUIRE(v.size() == 5);
+	CHECK(v[0] == "b");
+	CHECK(v[1] == "b");
+	CHECK(v[3] == "b");
+
+	ul::static_vector<int, 8> n(ul::list_construct, 1, 2, 3);
+	n.insert(n.begin() + 1, 3, n[2]);
+
+	CHECK(n == ul::static_vector<int, 6>(ul::list_construct, 1, 3, 3, 3, 2, 3));
+    }
+
+    SECTION("swap vectors of different sizes") {
+	ul::static_vector<std::string, 6> other(ul::list_construct, "x");
+	swap(v, other);
+
+	REQUIRE(v.size() == 1);
+	CHECK(v[0] == "x");
+	REQUIRE(other.size() == 3);
+	CHECK(other[2] == "c");
+
+	ul::static_vector<std::unique_ptr<int>, 2> p(ul::list_construct, std::make_unique<int>(1),
+						     std::make_unique<int>(2));
+	ul::static_vector<std::unique_ptr<int>, 2> q;
+	p.swap(q);
+
+	CHECK(p.empty());
+	REQUIRE(q.size() == 2);
+	CHECK(*q[1] == 2);
+    }
+}
+
+TEST_CASE("comparison of static_vector", "[static_vector]") {
+    const ul::static_vector<int, 4> v(ul::list_construct, 1, 2, 3);
+
+    CHECK(v == ul::static_vector<int, 8>(ul::list_construct, 1, 2, 3));
+    CHECK(v != ul::static_vector<int, 4>(ul::list_construct, 1, 2));
+    CHECK(v < ul::static_vector<int, 4>(ul::list_construct, 1, 3));
+    CHECK(v > ul::static_vector<int, 4>(ul::list_construct, 1, 2));
+    CHECK(v <= v);
+    CHECK(v >= ul::static_vector<int, 4>());
+}
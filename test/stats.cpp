@@ -0,0 +1,164 @@
+// Copyright Marcus Larsson 2018
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include <catch2/catch.hpp>
+#include <umlaut/allocator.hpp>
+#include <umlaut/flat_map.hpp>
+#include <umlaut/optional_array.hpp>
+#include <umlaut/small_string.hpp>
+#include <umlaut/small_vector.hpp>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace {
+
+const ul::small_vector_stats* find_site(const std::vector<ul::small_vector_stats>& sites, unsigned line) {
+    for (const auto& site : sites) {
+	if (site.line == line && std::strstr(site.file, "stats.cpp") != nullptr) {
+	    return &site;
+	}
+    }
+
+    return nullptr;
+}
+
+// Allocates room for 256 elements up front so that growing up to that is in place.
+template <typename T>
+struct in_place_reallocator : ul::reallocating_allocator<T> {
+    static constexpr std::size_t reserved = 256;
+
+    in_place_reallocator() = default;
+
+    template <typename U>
+    in_place_reallocator(const in_place_reallocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+	return ul::reallocating_allocator<T>::allocate(n < reserved ? reserved : n);
+    }
+
+    void deallocate(T* ptr, std::size_t n) noexcept {
+	ul::reallocating_allocator<T>::deallocate(ptr, n < reserved ? reserved : n);
+    }
+
+    T* reallocate(T* ptr, std::size_t old_n, std::size_t new_n) {
+	if (new_n <= reserved) return ptr;
+
+	return ul::reallocating_allocator<T>::reallocate(ptr, old_n < reserved ? reserved : old_n, new_n);
+    }
+};
+
+} // namespace
+
+TEST_CASE("statistics of small_vector", "[stats]") {
+    ul::reset_small_vector_stats();
+
+    SECTION("spills, reallocations and final sizes are recorded per construction site") {
+	const unsigned line = __LINE__ + 3;
+
+	for (int i = 0; i < 3; ++i) {
+	    ul::small_vector<int, 4> v;
+
+	    for (int j = 0; j < i * 4; ++j) v.push_back(j);
+	}
+
+	const auto sites = ul::collect_small_vector_stats();
+	const auto* site = find_site(sites, line);
+
+	REQUIRE(site != nullptr);
+	CHECK(site->vectors == 3);
+	CHECK(site->spills == 1);
+	CHECK(site->reallocations == 0);
+	CHECK(site->bytes_copied == 4 * sizeof(int));
+	CHECK(site->final_sizes[0] == 1);
+	CHECK(site->final_sizes[3] == 1);
+	CHECK(site->final_sizes[4] == 1);
+    }
+
+    SECTION("copies and moves are attributed to the original site") {
+	const unsigned line = __LINE__ + 1;
+	ul::small_vector_base<int> v(std::allocator<int>{});
+
+	for (int j = 0; j < 100; ++j) v.push_back(j);
+
+	{
+	    auto copy = v;
+	    ul::small_vector<int, 2> moved(std::move(copy));
+	}
+
+	const auto sites = ul::collect_small_vector_stats();
+	const auto* site = find_site(sites, line);
+
+	REQUIRE(site != nullptr);
+	CHECK(site->vectors == 2);
+	CHECK(site->spills == 2);
+	CHECK(site->reallocations > 0);
+	CHECK(site->final_sizes[7] == 1);
+    }
+
+    SECTION("growing in place copies no bytes") {
+	const unsigned line = __LINE__ + 1;
+	ul::small_vector<int, 4, in_place_reallocator<int>> v;
+
+	for (int j = 0; j < 200; ++j) v.push_back(j);
+
+	const auto sites = ul::collect_small_vector_stats();
+	const auto* site = find_site(sites, line);
+
+	REQUIRE(site != nullptr);
+	CHECK(site->spills == 1);
+	CHECK(site->reallocations > 0);
+	CHECK(site->bytes_copied == 4 * sizeof(int));
+    }
+
+    SECTION("statistics can be dumped") {
+	const unsigned line = __LINE__ + 1;
+	ul::small_vector<int, 1> v(ul::list_construct, 1, 2);
+	std::FILE* file = std::tmpfile();
+
+	REQUIRE(file != nullptr);
+	ul::dump_small_vector_stats(file);
+	CHECK(std::ftell(file) > 0);
+	std::fclose(file);
+
+	CHECK(find_site(ul::collect_small_vector_stats(), line) != nullptr);
+    }
+
+    SECTION("vectors constructed from a list of values record the caller") {
+	const unsigned line = __LINE__;
+	ul::small_vector<int, 1> list(ul::list_construct, 1, 2);
+	ul::small_vector_base<std::pair<int, int>> pairs(std::piecewise_construct, std::forward_as_tuple(1, 2));
+
+	const auto sites = ul::collect_small_vector_stats();
+
+	for (unsigned i = 1; i <= 2; ++i) {
+	    const auto* site = find_site(sites, line + i);
+	    REQUIRE(site != nullptr);
+	    CHECK(site->vectors == 1);
+	    CHECK(site->spills == 1);
+	}
+    }
+
+    SECTION("containers built on a vector record the caller") {
+	const unsigned line = __LINE__;
+	ul::small_string<4> string("a string too long for the inline buffer");
+	ul::flat_map<int, int, 2> map;
+	ul::flat_set<int, 2> set{std::less<int>()};
+	ul::optional_array<int> array(3);
+
+	const auto sites = ul::collect_small_vector_stats();
+
+	for (unsigned i = 1; i <= 3; ++i) {
+	    const auto* site = find_site(sites, line + i);
+	    REQUIRE(site != nullptr);
+	    CHECK(site->vectors == 1);
+	}
+
+	const auto* site = find_site(sites, line + 4);
+	REQUIRE(site != nullptr);
+	CHECK(site->vectors == 2);
+    }
+}